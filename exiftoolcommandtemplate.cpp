@@ -0,0 +1,173 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : pre-serialized ExifTool command.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "exiftoolcommandtemplate.h"
+
+namespace Digikam
+{
+
+namespace
+{
+
+// Sentinels surrounding the output of a command on both channels. The command identifier
+// is written with leading zeros, at constant size, at the two ID_POS positions.
+
+static const char SENTINELS[]       = "-echo1\n{await0000000000}\n"     // Echo text to stdout before processing is complete
+                                      "-echo2\n{await0000000000}\n";    // Echo text to stderr before processing is complete
+static const char READY_STDOUT[]    = "-echo3\n{ready}\n";              // Echo text to stdout after processing is complete
+static const char EXECUTE[]         = "-echo4\n{ready}\n"               // Echo text to stderr after processing is complete
+                                      "-execute\n";                     // Execute command and echo {ready} to stdout after processing is complete
+
+static const int  ID_SIZE           = 10;
+static const int  ID_POS[2]         = { 13, 38 };
+
+} // namespace
+
+ExifToolCommandTemplate::ExifToolCommandTemplate()
+    : m_count(0)
+{
+    setOptions(QByteArrayList());
+}
+
+ExifToolCommandTemplate::ExifToolCommandTemplate(const QByteArrayList& options)
+    : m_count(0)
+{
+    setOptions(options);
+}
+
+ExifToolCommandTemplate::~ExifToolCommandTemplate()
+{
+}
+
+bool ExifToolCommandTemplate::isQuietOption(const QByteArray& option)
+{
+    // ExifTool strips the white spaces around the arguments read with -@, and only -T is case sensitive.
+
+    const QByteArray trimmed = option.trimmed();
+    const QByteArray lower   = trimmed.toLower();
+
+    return ((lower == "-q") || (lower == "-quiet") || (trimmed == "-T") || (lower == "-table"));
+}
+
+void ExifToolCommandTemplate::setOptions(const QByteArrayList& options)
+{
+    bool quiet = false;
+
+    m_options.clear();
+
+    for (const QByteArray& option : options)
+    {
+        m_options.append(option);
+        m_options.append('\n');
+        quiet = quiet || isQuietOption(option);
+    }
+
+    m_count     = options.size();
+    m_sentinels = QByteArray(SENTINELS);
+
+    if (quiet)
+    {
+        m_sentinels.append(READY_STDOUT);
+    }
+
+    m_sentinels.append(EXECUTE);
+}
+
+QByteArrayList ExifToolCommandTemplate::options() const
+{
+    QByteArrayList options = m_options.split('\n');
+    options.removeLast();
+
+    return options;
+}
+
+bool ExifToolCommandTemplate::isEmpty() const
+{
+    return (m_count == 0);
+}
+
+bool ExifToolCommandTemplate::hasSameOptions(const ExifToolCommandTemplate& other) const
+{
+    return ((m_count == other.m_count) && (m_options == other.m_options));
+}
+
+QByteArray ExifToolCommandTemplate::serialize(int cmdId, const QByteArrayList& files) const
+{
+    int size = m_options.size() + m_sentinels.size();
+
+    for (const QByteArray& file : files)
+    {
+        size += file.size() + 1;
+    }
+
+    QByteArray cmd;
+    cmd.reserve(size);
+    cmd.append(m_options);
+
+    for (const QByteArray& file : files)
+    {
+        cmd.append(file);
+        cmd.append('\n');
+    }
+
+    appendSentinels(cmd, cmdId);
+
+    return cmd;
+}
+
+QByteArray ExifToolCommandTemplate::serialize(int cmdId, const QByteArray& file) const
+{
+    QByteArray cmd;
+    cmd.reserve(m_options.size() + file.size() + 1 + m_sentinels.size());
+    cmd.append(m_options);
+
+    if (!file.isEmpty())
+    {
+        cmd.append(file);
+        cmd.append('\n');
+    }
+
+    appendSentinels(cmd, cmdId);
+
+    return cmd;
+}
+
+void ExifToolCommandTemplate::appendSentinels(QByteArray& cmd, int cmdId) const
+{
+    // The command identifier is written in place of the placeholders, without temporary strings.
+
+    const int base = cmd.size();
+    cmd.append(m_sentinels);
+
+    char* const data = cmd.data() + base;
+    int id           = cmdId;
+
+    for (int i = ID_SIZE - 1 ; i >= 0 ; --i)
+    {
+        data[ID_POS[0] + i] = (char)('0' + (id % 10));
+        data[ID_POS[1] + i] = data[ID_POS[0] + i];
+        id                 /= 10;
+    }
+}
+
+} // namespace Digikam
@@ -0,0 +1,85 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : pre-serialized ExifTool command.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_EXIFTOOL_COMMAND_TEMPLATE_H
+#define DIGIKAM_EXIFTOOL_COMMAND_TEMPLATE_H
+
+// Qt Core
+
+#include <QByteArray>
+#include <QList>
+
+namespace Digikam
+{
+
+/**
+ * The options of an ExifTool command, serialized once in the stay_open protocol format.
+ * Sending the command for a file only splices the file name and the command identifier
+ * in the serialized bytes, without parsing the options again.
+ * A template is implicitly shared and cheap to copy.
+ */
+class ExifToolCommandTemplate
+{
+public:
+
+    ExifToolCommandTemplate();
+    explicit ExifToolCommandTemplate(const QByteArrayList& options);
+    ~ExifToolCommandTemplate();
+
+    /**
+     * Return true if ExifTool does not print {ready} on stdout after -execute with this option.
+     * The template echoes {ready} itself for such a command.
+     */
+    static bool    isQuietOption(const QByteArray& option);
+
+    void           setOptions(const QByteArrayList& options);
+    QByteArrayList options()                                        const;
+
+    bool           isEmpty()                                        const;
+
+    /**
+     * Return true if the options have the same serialized form.
+     */
+    bool           hasSameOptions(const ExifToolCommandTemplate& other) const;
+
+    /**
+     * Return the bytes to write to ExifTool to execute the command identified by cmdId
+     * on a list of files, which can be empty if the options are complete.
+     */
+    QByteArray     serialize(int cmdId, const QByteArrayList& files) const;
+    QByteArray     serialize(int cmdId, const QByteArray& file = QByteArray()) const;
+
+private:
+
+    void           appendSentinels(QByteArray& cmd, int cmdId) const;
+
+private:
+
+    QByteArray     m_options;               ///< Options, one per line.
+    QByteArray     m_sentinels;             ///< Sentinels and -execute, with a placeholder command id.
+    int            m_count;                 ///< Number of options.
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_EXIFTOOL_COMMAND_TEMPLATE_H
@@ -0,0 +1,197 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : benchmark of the ExifTool JSON output decoding.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+// Qt includes
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QVariantMap>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QDebug>
+
+// Local includes
+
+#include "exiftooljsondecoder.h"
+
+using namespace Digikam;
+
+namespace
+{
+
+/**
+ * The decoding done by ExifToolParser before ExifToolJsonDecoder: a QJsonDocument converted
+ * to QVariantMap, with each key split in sections and each value converted again to a map.
+ * Return the number of tags read.
+ */
+int legacyDecode(const QByteArray& json)
+{
+    int tags                  = 0;
+    QJsonDocument jsonDoc     = QJsonDocument::fromJson(json);
+    QJsonArray    jsonArray   = jsonDoc.array();
+
+    for (int i = 0 ; i < jsonArray.size() ; ++i)
+    {
+        QJsonObject   jsonObject  = jsonArray.at(i).toObject();
+        QVariantMap   metadataMap = jsonObject.toVariantMap();
+
+        for (QVariantMap::const_iterator it = metadataMap.constBegin() ;
+            it != metadataMap.constEnd() ; ++it)
+        {
+            QStringList sections  = it.key().split(QLatin1Char(':'));
+
+            if (sections[0] == QLatin1String("SourceFile"))
+            {
+                continue;
+            }
+
+            QVariantMap propsMap = it.value().toMap();
+            QString data         = propsMap.find(QLatin1String("val")).value().toString();
+            QString desc         = propsMap.find(QLatin1String("desc")).value().toString();
+
+            Q_UNUSED(data);
+            Q_UNUSED(desc);
+
+            ++tags;
+        }
+    }
+
+    return tags;
+}
+
+/**
+ * Receive the tags from ExifToolJsonDecoder with the same strings as the legacy path.
+ */
+class CountingHandler : public ExifToolJsonDecoder::Handler
+{
+public:
+
+    CountingHandler()
+      : tags(0)
+    {
+    }
+
+    void sourceFile(const QString&) override
+    {
+    }
+
+    void tag(const char* const key,
+             int keySize,
+             const QString& value,
+             const QString& description) override
+    {
+        const QString name = QString::fromUtf8(key, keySize);
+
+        Q_UNUSED(name);
+        Q_UNUSED(value);
+        Q_UNUSED(description);
+
+        ++tags;
+    }
+
+public:
+
+    int tags;
+};
+
+int singlePassDecode(const QByteArray& json)
+{
+    CountingHandler handler;
+    ExifToolJsonDecoder decoder(&handler);
+
+    if (!decoder.decode(json))
+    {
+        qWarning() << "Decoding error:" << decoder.errorString();
+    }
+
+    return handler.tags;
+}
+
+} // namespace
+
+/**
+ * Usage: exiftooldecoder_bench <capture> [iterations]
+ * The capture is the output of "exiftool -json -l -G:0:1:2:4:6 -n" on one or more files.
+ * It is decoded the given number of times, 200 by default, by each decoder.
+ */
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 2)
+    {
+        qDebug() << "exiftooldecoder_bench - ExifTool JSON decoding benchmark";
+        qDebug() << "Usage: <capture> [iterations]";
+        return -1;
+    }
+
+    QFile file(QString::fromLocal8Bit(argv[1]));
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Cannot read" << file.fileName();
+        return -1;
+    }
+
+    const QByteArray capture = file.readAll();
+    const int iterations     = (argc > 2) ? qMax(1, QByteArray(argv[2]).toInt()) : 200;
+    int legacyTags           = 0;
+    int singlePassTags       = 0;
+    QElapsedTimer timer;
+
+    timer.start();
+
+    for (int i = 0 ; i < iterations ; ++i)
+    {
+        legacyTags = legacyDecode(capture);
+    }
+
+    const qint64 legacyTime = timer.nsecsElapsed();
+
+    timer.restart();
+
+    for (int i = 0 ; i < iterations ; ++i)
+    {
+        singlePassTags = singlePassDecode(capture);
+    }
+
+    const qint64 singlePassTime = timer.nsecsElapsed();
+
+    if (legacyTags != singlePassTags)
+    {
+        qWarning() << "FAIL: tag counts differ:" << legacyTags << singlePassTags;
+        return 1;
+    }
+
+    qDebug().noquote() << QString::fromLatin1("%1 bytes, %2 tags, %3 iterations")
+                              .arg(capture.size()).arg(legacyTags).arg(iterations);
+    qDebug().noquote() << QString::fromLatin1("QJsonDocument + QVariantMap: %1 us per decode")
+                              .arg(legacyTime / 1000.0 / iterations, 0, 'f', 1);
+    qDebug().noquote() << QString::fromLatin1("ExifToolJsonDecoder:         %1 us per decode")
+                              .arg(singlePassTime / 1000.0 / iterations, 0, 'f', 1);
+
+    return 0;
+}
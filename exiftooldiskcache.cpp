@@ -0,0 +1,652 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : persistent cache of ExifTool parsed metadata.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "exiftooldiskcache.h"
+
+// Qt includes
+
+#include <QHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QtEndian>
+#include <QDebug>
+
+// C++ includes
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#   include <sys/types.h>
+#   include <sys/stat.h>
+#endif
+
+namespace Digikam
+{
+
+namespace
+{
+
+// File layout: a header, then records appended one after the other.
+// Header:  magic, format version, generation (incremented by each compaction).
+// Record:  magic, payload size, payload checksum, payload (key, path, parsed tags, ignored tags).
+
+static const quint32 FILE_MAGIC         = 0x43545845;       // "EXTC"
+static const quint32 FORMAT_VERSION     = 1;
+static const quint32 RECORD_MAGIC       = 0x52545845;       // "EXTR"
+static const int     HEADER_SIZE        = 16;
+static const int     RECORD_HEADER_SIZE = 12;
+static const int     LOCK_TIMEOUT       = 5000;             // In milliseconds.
+static const int     STREAM_VERSION     = QDataStream::Qt_5_6;  // Same payload format with Qt5 and Qt6.
+
+quint32 checksum(const char* const data, int size)
+{
+    // FNV-1a, enough to detect a torn or corrupted record.
+
+    quint32 hash = 2166136261U;
+
+    for (int i = 0 ; i < size ; ++i)
+    {
+        hash = (hash ^ (quint8)data[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+quint64 keyHash(const QByteArray& key)
+{
+    quint64 hash = 14695981039346656037ULL;
+
+    for (int i = 0 ; i < key.size() ; ++i)
+    {
+        hash = (hash ^ (quint8)key.at(i)) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+QByteArray fileHeader(quint64 generation)
+{
+    QByteArray header(HEADER_SIZE, '\0');
+    qToLittleEndian<quint32>(FILE_MAGIC,     reinterpret_cast<uchar*>(header.data()));
+    qToLittleEndian<quint32>(FORMAT_VERSION, reinterpret_cast<uchar*>(header.data() + 4));
+    qToLittleEndian<quint64>(generation,     reinterpret_cast<uchar*>(header.data() + 8));
+
+    return header;
+}
+
+/**
+ * Read the generation of a cache file header, or return false if the file is not a cache file.
+ */
+bool readHeader(const uchar* const data, qint64 size, quint64& generation)
+{
+    if ((size < HEADER_SIZE)                                    ||
+        (qFromLittleEndian<quint32>(data)     != FILE_MAGIC)    ||
+        (qFromLittleEndian<quint32>(data + 4) != FORMAT_VERSION))
+    {
+        return false;
+    }
+
+    generation = qFromLittleEndian<quint64>(data + 8);
+
+    return true;
+}
+
+} // namespace
+
+class Q_DECL_HIDDEN ExifToolDiskCache::Private
+{
+public:
+
+    explicit Private()
+      : map       (nullptr),
+        mapSize   (0),
+        scanned   (0),
+        generation(0),
+        records   (0),
+        opened    (false)
+    {
+    }
+
+    void close()
+    {
+        if (map)
+        {
+            file.unmap(map);
+            map = nullptr;
+        }
+
+        file.close();
+        index.clear();
+        mapSize = 0;
+        scanned = 0;
+        records = 0;
+        opened  = false;
+    }
+
+    /**
+     * Map the whole file, to read the records appended since the last mapping.
+     */
+    bool remap()
+    {
+        const qint64 size = file.size();
+
+        if (map && (size == mapSize))
+        {
+            return true;
+        }
+
+        if (map)
+        {
+            file.unmap(map);
+            map     = nullptr;
+            mapSize = 0;
+        }
+
+        map = file.map(0, size);
+
+        if (!map)
+        {
+            qWarning() << "ExifToolDiskCache: cannot map" << filePath << ":" << file.errorString();
+            return false;
+        }
+
+        mapSize = size;
+
+        return true;
+    }
+
+    /**
+     * Return the payload of the valid record at an offset, and the offset of the next record.
+     */
+    bool record(qint64 offset, QByteArray& payload, qint64& next) const
+    {
+        if ((offset + RECORD_HEADER_SIZE) > mapSize)
+        {
+            return false;
+        }
+
+        const uchar* const data = map + offset;
+        const quint32 size      = qFromLittleEndian<quint32>(data + 4);
+
+        if ((qFromLittleEndian<quint32>(data) != RECORD_MAGIC) ||
+            ((offset + RECORD_HEADER_SIZE + (qint64)size) > mapSize))
+        {
+            return false;
+        }
+
+        const char* const bytes = reinterpret_cast<const char*>(data + RECORD_HEADER_SIZE);
+
+        if (checksum(bytes, size) != qFromLittleEndian<quint32>(data + 8))
+        {
+            return false;
+        }
+
+        // The payload is read in place from the mapping, without copy.
+
+        payload = QByteArray::fromRawData(bytes, size);
+        next    = offset + RECORD_HEADER_SIZE + size;
+
+        return true;
+    }
+
+    /**
+     * Index the valid records appended after the last scanned one. Scanning stops at a torn record.
+     */
+    void scanTail()
+    {
+        if (!remap())
+        {
+            return;
+        }
+
+        QByteArray payload;
+        qint64 next = 0;
+
+        while (record(scanned, payload, next))
+        {
+            QDataStream stream(payload);
+            stream.setVersion(STREAM_VERSION);
+            QByteArray key;
+            stream >> key;
+
+            index.insert(keyHash(key), scanned);
+            scanned = next;
+            ++records;
+        }
+    }
+
+    /**
+     * Follow the changes made by the other writers: appended records, or a compacted file.
+     * With locked, the caller already holds the lock file.
+     */
+    void refresh(bool locked = false)
+    {
+        QFile current(filePath);
+        quint64 currentGeneration = 0;
+
+        if (current.open(QIODevice::ReadOnly))
+        {
+            const QByteArray header = current.read(HEADER_SIZE);
+
+            if (readHeader(reinterpret_cast<const uchar*>(header.constData()), header.size(), currentGeneration) &&
+                (currentGeneration == generation))
+            {
+                scanTail();
+
+                return;
+            }
+        }
+
+        open(locked);
+    }
+
+    bool open(bool locked = false)
+    {
+        close();
+
+        // Create the file, or replace a file which is not a cache.
+
+        {
+            QLockFile lock(filePath + QLatin1String(".lock"));
+
+            if (!locked && !lock.tryLock(LOCK_TIMEOUT))
+            {
+                qWarning() << "ExifToolDiskCache: cannot lock" << filePath;
+                return false;
+            }
+
+            QFile current(filePath);
+            quint64 currentGeneration = 0;
+
+            if (current.open(QIODevice::ReadOnly))
+            {
+                const QByteArray header = current.read(HEADER_SIZE);
+
+                if (!readHeader(reinterpret_cast<const uchar*>(header.constData()), header.size(), currentGeneration))
+                {
+                    qWarning() << "ExifToolDiskCache:" << filePath << "is not a cache file, it is reset";
+                    current.close();
+                    current.remove();
+                }
+            }
+
+            if (!current.exists())
+            {
+                QSaveFile save(filePath);
+
+                if (!save.open(QIODevice::WriteOnly)               ||
+                    (save.write(fileHeader(1)) != HEADER_SIZE)     ||
+                    !save.commit())
+                {
+                    qWarning() << "ExifToolDiskCache: cannot create" << filePath << ":" << save.errorString();
+                    return false;
+                }
+            }
+        }
+
+        file.setFileName(filePath);
+
+        if (!file.open(QIODevice::ReadOnly) || !remap() || !readHeader(map, mapSize, generation))
+        {
+            qWarning() << "ExifToolDiskCache: cannot open" << filePath;
+            close();
+
+            return false;
+        }
+
+        scanned = HEADER_SIZE;
+        opened  = true;
+        scanTail();
+
+        return true;
+    }
+
+public:
+
+    QString                 filePath;
+    QFile                   file;               ///< Cache file of the current generation, open for reading.
+    uchar*                  map;
+    qint64                  mapSize;
+    qint64                  scanned;            ///< End of the last valid record indexed.
+    quint64                 generation;
+    int                     records;            ///< Number of valid records in the file.
+    bool                    opened;
+    QHash<quint64, qint64>  index;              ///< Offset of the last record by key hash.
+};
+
+ExifToolDiskCache::ExifToolDiskCache(const QString& filePath)
+    : d(new Private)
+{
+    d->filePath = filePath;
+}
+
+ExifToolDiskCache::~ExifToolDiskCache()
+{
+    d->close();
+
+    delete d;
+}
+
+QString ExifToolDiskCache::filePath() const
+{
+    return d->filePath;
+}
+
+bool ExifToolDiskCache::open()
+{
+    return d->open();
+}
+
+bool ExifToolDiskCache::isOpen() const
+{
+    return d->opened;
+}
+
+int ExifToolDiskCache::size() const
+{
+    return d->index.size();
+}
+
+QByteArray ExifToolDiskCache::fileKey(const QString& path)
+{
+    const QFileInfo info(path);
+    const QString canonical = info.canonicalFilePath();
+
+    if (canonical.isEmpty())
+    {
+        return QByteArray();
+    }
+
+    QByteArray key = canonical.toUtf8();
+    key.append('\0');
+    key.append(QByteArray::number(info.size()));
+    key.append(':');
+    key.append(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+
+#ifdef Q_OS_UNIX
+
+    // The inode detects a file replaced by another one with the same size and date.
+
+    struct stat st;
+
+    if (::stat(QFile::encodeName(canonical).constData(), &st) == 0)
+    {
+        key.append(':');
+        key.append(QByteArray::number((qulonglong)st.st_ino));
+        key.append(':');
+        key.append(QByteArray::number((qulonglong)st.st_dev));
+    }
+
+#endif
+
+    return key;
+}
+
+bool ExifToolDiskCache::lookup(const QString& path,
+                               const QByteArray& context,
+                               ExifToolParser::LoadResult& result)
+{
+    if (!d->opened)
+    {
+        return false;
+    }
+
+    const QByteArray stateKey = fileKey(path);
+
+    if (stateKey.isEmpty())
+    {
+        return false;
+    }
+
+    const QByteArray key = context + '\n' + stateKey;
+    const quint64 hash   = keyHash(key);
+
+    QHash<quint64, qint64>::const_iterator it = d->index.constFind(hash);
+
+    if (it == d->index.constEnd())
+    {
+        // The file may have been added by another process.
+
+        d->refresh();
+        it = d->index.constFind(hash);
+
+        if (it == d->index.constEnd())
+        {
+            return false;
+        }
+    }
+
+    QByteArray payload;
+    qint64 next = 0;
+
+    // A record appended by this instance is not mapped yet.
+
+    if (!d->record(it.value(), payload, next) && (!d->remap() || !d->record(it.value(), payload, next)))
+    {
+        return false;
+    }
+
+    QDataStream stream(payload);
+    stream.setVersion(STREAM_VERSION);
+    QByteArray storedKey;
+    ExifToolParser::TagsMap parsed;
+    ExifToolParser::TagsMap ignored;
+
+    stream >> storedKey;
+
+    if (storedKey != key)
+    {
+        return false;
+    }
+
+    stream >> result.path >> parsed >> ignored;
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        return false;
+    }
+
+    result.parsedTags  = ExifToolTagStore::fromTagsMap(parsed);
+    result.ignoredTags = ExifToolTagStore::fromTagsMap(ignored);
+    result.errorString.clear();
+
+    return true;
+}
+
+bool ExifToolDiskCache::insert(const QString& path,
+                               const QByteArray& context,
+                               const QByteArray& stateKey,
+                               const ExifToolParser::LoadResult& result)
+{
+    if (!d->opened || !result.isValid() || stateKey.isEmpty())
+    {
+        return false;
+    }
+
+    if (fileKey(path) != stateKey)
+    {
+        return false;
+    }
+
+    const QByteArray key = context + '\n' + stateKey;
+
+    QByteArray data(RECORD_HEADER_SIZE, '\0');
+
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly | QIODevice::Append);
+        stream.setVersion(STREAM_VERSION);
+        stream << key << result.path << result.parsedTags.toTagsMap() << result.ignoredTags.toTagsMap();
+    }
+
+    const int size = data.size() - RECORD_HEADER_SIZE;
+    qToLittleEndian<quint32>(RECORD_MAGIC,                                         reinterpret_cast<uchar*>(data.data()));
+    qToLittleEndian<quint32>(size,                                                 reinterpret_cast<uchar*>(data.data() + 4));
+    qToLittleEndian<quint32>(checksum(data.constData() + RECORD_HEADER_SIZE, size), reinterpret_cast<uchar*>(data.data() + 8));
+
+    QLockFile lock(d->filePath + QLatin1String(".lock"));
+
+    if (!lock.tryLock(LOCK_TIMEOUT))
+    {
+        qWarning() << "ExifToolDiskCache: cannot lock" << d->filePath;
+        return false;
+    }
+
+    // Index the records of the other writers first, to append after the last valid one.
+
+    d->refresh(true);
+
+    if (!d->opened)
+    {
+        return false;
+    }
+
+    QFile out(d->filePath);
+
+    if (!out.open(QIODevice::ReadWrite))
+    {
+        qWarning() << "ExifToolDiskCache: cannot write" << d->filePath << ":" << out.errorString();
+        return false;
+    }
+
+    // Drop a record torn by a writer which crashed.
+
+    if (out.size() > d->scanned)
+    {
+        out.resize(d->scanned);
+    }
+
+    if (!out.seek(d->scanned) || (out.write(data) != data.size()) || !out.flush())
+    {
+        qWarning() << "ExifToolDiskCache: cannot write" << d->filePath << ":" << out.errorString();
+        out.resize(d->scanned);
+
+        return false;
+    }
+
+    out.close();
+
+    // The new record is mapped on the next read.
+
+    d->index.insert(keyHash(key), d->scanned);
+    d->scanned += data.size();
+    ++d->records;
+
+    return true;
+}
+
+bool ExifToolDiskCache::compact()
+{
+    if (!d->opened)
+    {
+        return false;
+    }
+
+    QLockFile lock(d->filePath + QLatin1String(".lock"));
+
+    if (!lock.tryLock(LOCK_TIMEOUT))
+    {
+        qWarning() << "ExifToolDiskCache: cannot lock" << d->filePath;
+        return false;
+    }
+
+    d->refresh(true);
+
+    if (!d->opened || !d->remap())
+    {
+        return false;
+    }
+
+    // Keep the last record of each key, if the file did not change since.
+
+    QList<qint64> kept;
+
+    for (QHash<quint64, qint64>::const_iterator it = d->index.constBegin() ; it != d->index.constEnd() ; ++it)
+    {
+        QByteArray payload;
+        qint64 next = 0;
+
+        if (!d->record(it.value(), payload, next))
+        {
+            continue;
+        }
+
+        QDataStream stream(payload);
+        stream.setVersion(STREAM_VERSION);
+        QByteArray key;
+        stream >> key;
+
+        const QByteArray stateKey = key.mid(key.indexOf('\n') + 1);
+        const QString path        = QString::fromUtf8(stateKey.constData());       // Up to the '\0' after the path.
+
+        if (fileKey(path) == stateKey)
+        {
+            kept << it.value();
+        }
+    }
+
+    if (kept.size() == d->records)
+    {
+        return true;
+    }
+
+    // Records are copied in file order, to read the mapping sequentially.
+
+    std::sort(kept.begin(), kept.end());
+
+    QSaveFile save(d->filePath);
+
+    if (!save.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "ExifToolDiskCache: cannot compact" << d->filePath << ":" << save.errorString();
+        return false;
+    }
+
+    save.write(fileHeader(d->generation + 1));
+
+    for (qint64 offset : kept)
+    {
+        QByteArray payload;
+        qint64 next = 0;
+
+        d->record(offset, payload, next);
+        save.write(reinterpret_cast<const char*>(d->map + offset), next - offset);
+    }
+
+    if (!save.commit())
+    {
+        qWarning() << "ExifToolDiskCache: cannot compact" << d->filePath << ":" << save.errorString();
+        return false;
+    }
+
+    qDebug() << "ExifToolDiskCache: compacted" << d->filePath << "from" << d->records << "to" << kept.size() << "records";
+
+    lock.unlock();
+
+    return d->open();
+}
+
+} // namespace Digikam
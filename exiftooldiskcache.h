@@ -0,0 +1,115 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : persistent cache of ExifTool parsed metadata.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_EXIFTOOL_DISK_CACHE_H
+#define DIGIKAM_EXIFTOOL_DISK_CACHE_H
+
+// Qt Core
+
+#include <QString>
+#include <QByteArray>
+
+// Local includes
+
+#include "exiftoolparser.h"
+
+namespace Digikam
+{
+
+/**
+ * Persistent cache of the metadata parsed from files, stored in an append-only binary file
+ * which is memory-mapped for reading.
+ *
+ * A result is keyed by the canonical path of the file, its size, modification time and inode,
+ * and by a context describing the ExifTool program and the options of the load. A lookup
+ * stats the file and probes an in-memory index: a changed file is a miss.
+ *
+ * Each record has a checksum: a record torn by a crash is ignored, and dropped by the next
+ * writer. Writers from any process are serialized with a lock file. compact() rewrites the file
+ * atomically without the replaced and stale records, and readers of other processes reload it.
+ *
+ * An instance is not thread-safe, but any number of instances and processes can share a file.
+ */
+class ExifToolDiskCache
+{
+public:
+
+    explicit ExifToolDiskCache(const QString& filePath);
+    ~ExifToolDiskCache();
+
+    QString filePath()                                                  const;
+
+    /**
+     * Open the cache file, created if necessary, and index its records.
+     * Return false if the file cannot be used.
+     */
+    bool    open();
+    bool    isOpen()                                                    const;
+
+    /**
+     * Read the result of a file loaded with a context. Return false on a miss.
+     */
+    bool    lookup(const QString& path,
+                   const QByteArray& context,
+                   ExifToolParser::LoadResult& result);
+
+    /**
+     * Append the result of a file loaded with a context. fileKey is the state of the file
+     * taken before it was loaded: the result is dropped if the file changed since.
+     */
+    bool    insert(const QString& path,
+                   const QByteArray& context,
+                   const QByteArray& fileKey,
+                   const ExifToolParser::LoadResult& result);
+
+    /**
+     * Rewrite the cache file with only the last record of each file still unchanged on disk.
+     */
+    bool    compact();
+
+    /**
+     * Return the number of records indexed.
+     */
+    int     size()                                                      const;
+
+    /**
+     * Return a key identifying the current state of a file: its canonical path, size,
+     * modification time and inode. Return an empty array if the file does not exist.
+     */
+    static QByteArray fileKey(const QString& path);
+
+private:
+
+    // Disable
+    ExifToolDiskCache(const ExifToolDiskCache&)            = delete;
+    ExifToolDiskCache& operator=(const ExifToolDiskCache&) = delete;
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_EXIFTOOL_DISK_CACHE_H
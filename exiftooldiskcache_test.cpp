@@ -0,0 +1,270 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : tests of the persistent cache of parsed metadata.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+// Qt includes
+
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QVariant>
+#include <QDebug>
+
+// Local includes
+
+#include "exiftooldiskcache.h"
+
+using namespace Digikam;
+
+namespace
+{
+
+#define CHECK(condition)                                                          \
+    if (!(condition))                                                             \
+    {                                                                             \
+        qWarning() << "Check failed at line" << __LINE__ << ":" << #condition;    \
+        return false;                                                             \
+    }
+
+static const QByteArray CONTEXT("test");
+
+QString createFile(const QTemporaryDir& dir, const QString& name)
+{
+    const QString path = dir.filePath(name);
+    QFile file(path);
+
+    if (file.open(QIODevice::WriteOnly))
+    {
+        file.write("data");
+    }
+
+    return path;
+}
+
+ExifToolParser::LoadResult result(const QString& path)
+{
+    ExifToolParser::LoadResult res;
+    res.path = path;
+    res.parsedTags.insert(QLatin1String("EXIF.IFD0.Camera.Make"), QLatin1String("Make"),
+                          QLatin1String("digiKam"), QLatin1String("string"), QLatin1String("Camera Make"));
+    res.parsedTags.squeeze();
+
+    return res;
+}
+
+bool insert(ExifToolDiskCache& cache, const QString& path)
+{
+    return cache.insert(path, CONTEXT, ExifToolDiskCache::fileKey(path), result(path));
+}
+
+bool contains(ExifToolDiskCache& cache, const QString& path)
+{
+    ExifToolParser::LoadResult res;
+
+    return (cache.lookup(path, CONTEXT, res) && (res.path == path));
+}
+
+qint64 fileSize(const QString& path)
+{
+    return QFile(path).size();
+}
+
+/**
+ * A result is read back by another instance, with its tags, and only for its context.
+ */
+bool testInsertLookup(const QTemporaryDir& dir)
+{
+    const QString cachePath = dir.filePath(QLatin1String("lookup.cache"));
+    const QString path      = createFile(dir, QLatin1String("lookup.jpg"));
+
+    {
+        ExifToolDiskCache cache(cachePath);
+        CHECK(cache.open());
+        CHECK(!contains(cache, path));
+        CHECK(insert(cache, path));
+        CHECK(contains(cache, path));
+    }
+
+    ExifToolDiskCache cache(cachePath);
+    CHECK(cache.open());
+    CHECK(cache.size() == 1);
+
+    ExifToolParser::LoadResult res;
+    CHECK(cache.lookup(path, CONTEXT, res));
+    CHECK(res.parsedTags.value(QLatin1String("EXIF.IFD0.Camera.Make")).toString() == QLatin1String("digiKam"));
+    CHECK(!cache.lookup(path, QByteArray("other"), res));
+
+    return true;
+}
+
+/**
+ * A record torn by a writer which crashed is ignored by the readers, with the records after it,
+ * and dropped by the next writer: the records written before and after the crash are readable.
+ */
+bool testTornRecord(const QTemporaryDir& dir)
+{
+    const QString cachePath = dir.filePath(QLatin1String("torn.cache"));
+    const QString first     = createFile(dir, QLatin1String("torn1.jpg"));
+    const QString torn      = createFile(dir, QLatin1String("torn2.jpg"));
+    const QString next      = createFile(dir, QLatin1String("torn3.jpg"));
+    qint64 validSize        = 0;
+
+    {
+        ExifToolDiskCache cache(cachePath);
+        CHECK(cache.open());
+        CHECK(insert(cache, first));
+        validSize = fileSize(cachePath);
+        CHECK(insert(cache, torn));
+    }
+
+    // Cut the last record in the middle.
+
+    {
+        QFile file(cachePath);
+        CHECK(file.resize(validSize + (fileSize(cachePath) - validSize) / 2));
+    }
+
+    {
+        ExifToolDiskCache cache(cachePath);
+        CHECK(cache.open());
+        CHECK(cache.size() == 1);
+        CHECK(contains(cache, first));
+        CHECK(!contains(cache, torn));
+
+        CHECK(insert(cache, next));
+        CHECK(contains(cache, next));
+    }
+
+    ExifToolDiskCache cache(cachePath);
+    CHECK(cache.open());
+    CHECK(cache.size() == 2);
+    CHECK(contains(cache, first));
+    CHECK(contains(cache, next));
+    CHECK(!contains(cache, torn));
+
+    // Garbage after the last record is dropped the same way.
+
+    {
+        QFile file(cachePath);
+        CHECK(file.open(QIODevice::Append));
+        file.write("EXTR garbage written by a crashed writer");
+    }
+
+    ExifToolDiskCache other(cachePath);
+    CHECK(other.open());
+    CHECK(other.size() == 2);
+    CHECK(insert(other, torn));
+    CHECK(contains(other, torn));
+    CHECK(contains(cache, torn));
+
+    // Written over the garbage, not after it.
+
+    ExifToolDiskCache reopened(cachePath);
+    CHECK(reopened.open());
+    CHECK(reopened.size() == 3);
+    CHECK(contains(reopened, torn));
+
+    return true;
+}
+
+/**
+ * compact() keeps the last record of each unchanged file. An instance opened before
+ * the compaction follows the new file.
+ */
+bool testCompaction(const QTemporaryDir& dir)
+{
+    const QString cachePath = dir.filePath(QLatin1String("compact.cache"));
+    const QString kept      = createFile(dir, QLatin1String("compact1.jpg"));
+    const QString replaced  = createFile(dir, QLatin1String("compact2.jpg"));
+    const QString changed   = createFile(dir, QLatin1String("compact3.jpg"));
+
+    ExifToolDiskCache old(cachePath);
+    CHECK(old.open());
+    CHECK(insert(old, kept));
+    CHECK(insert(old, replaced));
+    CHECK(insert(old, replaced));
+    CHECK(insert(old, changed));
+    CHECK(old.size() == 3);
+
+    {
+        QFile file(changed);
+        CHECK(file.open(QIODevice::Append));
+        file.write("more data");
+    }
+
+    const qint64 size = fileSize(cachePath);
+
+    ExifToolDiskCache cache(cachePath);
+    CHECK(cache.open());
+    CHECK(cache.compact());
+    CHECK(cache.size() == 2);
+    CHECK(fileSize(cachePath) < size);
+    CHECK(contains(cache, kept));
+    CHECK(contains(cache, replaced));
+    CHECK(!contains(cache, changed));
+
+    // Nothing left to drop: the file is not rewritten.
+
+    const qint64 compactedSize = fileSize(cachePath);
+    CHECK(cache.compact());
+    CHECK(fileSize(cachePath) == compactedSize);
+
+    // The other instance reloads the compacted file before appending to it.
+
+    CHECK(insert(old, changed));
+    CHECK(contains(old, changed));
+    CHECK(old.size() == 3);
+    CHECK(contains(cache, changed));
+
+    ExifToolDiskCache reopened(cachePath);
+    CHECK(reopened.open());
+    CHECK(reopened.size() == 3);
+    CHECK(contains(reopened, kept));
+    CHECK(contains(reopened, replaced));
+    CHECK(contains(reopened, changed));
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QTemporaryDir dir;
+
+    if (!dir.isValid())
+    {
+        qWarning() << "Cannot create a temporary directory";
+        return 1;
+    }
+
+    if (!testInsertLookup(dir) || !testTornRecord(dir) || !testCompaction(dir))
+    {
+        qWarning() << "FAIL: ExifToolDiskCache";
+        return 1;
+    }
+
+    qDebug() << "PASS: ExifToolDiskCache";
+
+    return 0;
+}
@@ -0,0 +1,189 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : microbenchmark of the ExifTool output framing.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+// Qt includes
+
+#include <QCoreApplication>
+#include <QBuffer>
+#include <QFile>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QDebug>
+
+// Local includes
+
+#include "exiftooloutputframer.h"
+
+using namespace Digikam;
+
+namespace
+{
+
+/// Size of the reads from the pipe simulated for the framer.
+static const int CHUNK_SIZE = 65536;
+
+/// Largest stream framed by the benchmark, below the 2 GB limit of a QByteArray with Qt5.
+static const qint64 MAX_STREAM_SIZE = (qint64)1 << 30;
+
+/**
+ * The line by line framing used by ExifToolProcess::readOutput() before ExifToolOutputFramer.
+ * The whole stream is available at once, which is the best case for canReadLine().
+ */
+QHash<int, QByteArray> legacyFraming(const QByteArray& stream)
+{
+    QHash<int, QByteArray> done;
+    QByteArray outBuff;
+    int outAwait = 0;
+
+    QBuffer device;
+    device.setData(stream);
+    device.open(QIODevice::ReadOnly);
+
+    while (device.canReadLine())
+    {
+        QByteArray line = device.readLine();
+
+        if (line.endsWith(QByteArray("\r\n")))
+        {
+            line.remove(line.size() - 2, 1); // Remove '\r' character
+        }
+
+        if (!outAwait)
+        {
+            if (line.startsWith(QByteArray("{await")) && line.endsWith(QByteArray("}\n")))
+            {
+                outAwait = line.mid(6, line.size() - 8).toInt();
+            }
+
+            continue;
+        }
+
+        outBuff += line;
+
+        if (line.endsWith(QByteArray("{ready}\n")))
+        {
+            outBuff.chop(8);
+            done.insert(outAwait, outBuff);
+            outBuff  = QByteArray();
+            outAwait = 0;
+        }
+    }
+
+    return done;
+}
+
+QHash<int, QByteArray> chunkedFraming(const QByteArray& stream)
+{
+    ExifToolOutputFramer framer;
+
+    for (int pos = 0 ; pos < stream.size() ; pos += CHUNK_SIZE)
+    {
+        framer.buffer.append(stream.constData() + pos, qMin(CHUNK_SIZE, stream.size() - pos));
+        framer.scan();
+    }
+
+    return framer.done;
+}
+
+} // namespace
+
+/**
+ * Usage: exiftoolframing_bench <capture> [commands]
+ * The capture is the output of one ExifTool command, e.g. "exiftool -json -l -G:0:1:2:4:6 -n image.raw".
+ * It is framed as the output of the given number of commands, 1000 by default.
+ */
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 2)
+    {
+        qDebug() << "exiftoolframing_bench - ExifTool output framing benchmark";
+        qDebug() << "Usage: <capture> [commands]";
+        return -1;
+    }
+
+    QFile file(QString::fromLocal8Bit(argv[1]));
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Cannot read" << file.fileName();
+        return -1;
+    }
+
+    const QByteArray capture = file.readAll();
+    int commands             = (argc > 2) ? qMax(1, QByteArray(argv[2]).toInt()) : 1000;
+
+    // Each command adds at most 27 bytes of sentinels to the capture. Computed in 64 bits: the stream must fit in a QByteArray.
+
+    const qint64 commandSize = (qint64)capture.size() + 32;
+    const qint64 maxCommands = MAX_STREAM_SIZE / commandSize;
+
+    if (commands > maxCommands)
+    {
+        qWarning() << "Framing only" << maxCommands << "commands: the stream is limited to" << MAX_STREAM_SIZE << "bytes";
+        commands = (int)qMax((qint64)1, maxCommands);
+    }
+
+    QByteArray stream;
+    stream.reserve((int)qMin(commandSize * commands, MAX_STREAM_SIZE));
+
+    for (int i = 1 ; i <= commands ; ++i)
+    {
+        stream += "{await" + QByteArray::number(i).rightJustified(10, '0') + "}\n";
+        stream += capture;
+
+        if (!capture.endsWith('\n'))
+        {
+            stream += '\n';
+        }
+
+        stream += "{ready}\n";
+    }
+
+    QElapsedTimer timer;
+
+    timer.start();
+    const QHash<int, QByteArray> legacy = legacyFraming(stream);
+    const qint64 legacyTime             = timer.nsecsElapsed();
+
+    timer.restart();
+    const QHash<int, QByteArray> chunked = chunkedFraming(stream);
+    const qint64 chunkedTime             = timer.nsecsElapsed();
+
+    if (legacy != chunked)
+    {
+        qWarning() << "FAIL: framings differ";
+        return 1;
+    }
+
+    const double mib = stream.size() / (1024.0 * 1024.0);
+
+    qDebug().noquote() << QString::fromLatin1("%1 commands, %2 MiB").arg(commands).arg(mib, 0, 'f', 1);
+    qDebug().noquote() << QString::fromLatin1("line by line: %1 ms, %2 MiB/s")
+                              .arg(legacyTime / 1000000.0, 0, 'f', 1).arg(mib * 1.0e9 / qMax(legacyTime, (qint64)1), 0, 'f', 0);
+    qDebug().noquote() << QString::fromLatin1("chunked:      %1 ms, %2 MiB/s")
+                              .arg(chunkedTime / 1000000.0, 0, 'f', 1).arg(mib * 1.0e9 / qMax(chunkedTime, (qint64)1), 0, 'f', 0);
+
+    return 0;
+}
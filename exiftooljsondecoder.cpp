@@ -0,0 +1,630 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : single pass decoder of ExifTool JSON output.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "exiftooljsondecoder.h"
+
+// C++ includes
+
+#include <cstring>
+
+namespace Digikam
+{
+
+namespace
+{
+
+bool isDelimiter(char c)
+{
+    return ((c == ',') || (c == '}') || (c == ']') ||
+            (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'));
+}
+
+int hexValue(char c)
+{
+    if ((c >= '0') && (c <= '9'))
+    {
+        return (c - '0');
+    }
+
+    if ((c >= 'a') && (c <= 'f'))
+    {
+        return (c - 'a' + 10);
+    }
+
+    if ((c >= 'A') && (c <= 'F'))
+    {
+        return (c - 'A' + 10);
+    }
+
+    return -1;
+}
+
+void appendUtf8(QByteArray& out, uint code)
+{
+    if      (code < 0x80)
+    {
+        out.append((char)code);
+    }
+    else if (code < 0x800)
+    {
+        out.append((char)(0xC0 | (code >> 6)));
+        out.append((char)(0x80 | (code & 0x3F)));
+    }
+    else if (code < 0x10000)
+    {
+        out.append((char)(0xE0 | (code >> 12)));
+        out.append((char)(0x80 | ((code >> 6) & 0x3F)));
+        out.append((char)(0x80 | (code & 0x3F)));
+    }
+    else
+    {
+        out.append((char)(0xF0 | (code >> 18)));
+        out.append((char)(0x80 | ((code >> 12) & 0x3F)));
+        out.append((char)(0x80 | ((code >> 6) & 0x3F)));
+        out.append((char)(0x80 | (code & 0x3F)));
+    }
+}
+
+} // namespace
+
+ExifToolJsonDecoder::ExifToolJsonDecoder(Handler* const handler)
+    : m_handler(handler),
+      m_pos    (nullptr),
+      m_end    (nullptr),
+      m_begin  (nullptr)
+{
+}
+
+ExifToolJsonDecoder::~ExifToolJsonDecoder()
+{
+}
+
+QString ExifToolJsonDecoder::errorString() const
+{
+    return m_error;
+}
+
+bool ExifToolJsonDecoder::decode(const QByteArray& json)
+{
+    return decode(json.constData(), json.size());
+}
+
+bool ExifToolJsonDecoder::decode(const char* const data, int size)
+{
+    m_begin = data;
+    m_pos   = data;
+    m_end   = data + size;
+    m_error.clear();
+
+    skipSpaces();
+
+    if (m_pos == m_end)
+    {
+        return true;        // No file: ExifTool only reported errors.
+    }
+
+    if (!expect('['))
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        skipSpaces();
+
+        if ((m_pos < m_end) && (*m_pos == ']'))
+        {
+            ++m_pos;
+
+            return true;
+        }
+
+        if (!parseFile())
+        {
+            return false;
+        }
+
+        skipSpaces();
+
+        if ((m_pos < m_end) && (*m_pos == ','))
+        {
+            ++m_pos;
+            continue;
+        }
+
+        return expect(']');
+    }
+}
+
+bool ExifToolJsonDecoder::parseFile()
+{
+    if (!expect('{'))
+    {
+        return false;
+    }
+
+    m_handler->startFile();
+
+    QString value;
+
+    while (true)
+    {
+        skipSpaces();
+
+        if ((m_pos < m_end) && (*m_pos == '}'))
+        {
+            ++m_pos;
+            m_handler->endFile();
+
+            return true;
+        }
+
+        const char* key = nullptr;
+        int keySize     = 0;
+
+        if (!parseString(key, keySize, m_keyScratch) || !expect(':'))
+        {
+            return false;
+        }
+
+        skipSpaces();
+
+        if      ((keySize == 10) && (memcmp(key, "SourceFile", 10) == 0))
+        {
+            if (!parseValue(value))
+            {
+                return false;
+            }
+
+            m_handler->sourceFile(value);
+        }
+        else if ((m_pos < m_end) && (*m_pos == '{'))
+        {
+            // Tag with its properties (-l option).
+
+            if (!parseTag(key, keySize))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if (!parseValue(value))
+            {
+                return false;
+            }
+
+            m_handler->tag(key, keySize, value, QString());
+        }
+
+        skipSpaces();
+
+        if ((m_pos < m_end) && (*m_pos == ','))
+        {
+            ++m_pos;
+        }
+    }
+}
+
+bool ExifToolJsonDecoder::parseTag(const char* const key, int keySize)
+{
+    if (!expect('{'))
+    {
+        return false;
+    }
+
+    QString value;
+    QString desc;
+
+    while (true)
+    {
+        skipSpaces();
+
+        if ((m_pos < m_end) && (*m_pos == '}'))
+        {
+            ++m_pos;
+            m_handler->tag(key, keySize, value, desc);
+
+            return true;
+        }
+
+        const char* prop = nullptr;
+        int propSize     = 0;
+
+        if (!parseString(prop, propSize, m_valueScratch) || !expect(':'))
+        {
+            return false;
+        }
+
+        bool ok = true;
+
+        if      ((propSize == 3) && (memcmp(prop, "val", 3) == 0))
+        {
+            ok = parseValue(value);
+        }
+        else if ((propSize == 4) && (memcmp(prop, "desc", 4) == 0))
+        {
+            ok = parseValue(desc);
+        }
+        else
+        {
+            ok = skipValue();
+        }
+
+        if (!ok)
+        {
+            return false;
+        }
+
+        skipSpaces();
+
+        if ((m_pos < m_end) && (*m_pos == ','))
+        {
+            ++m_pos;
+        }
+    }
+}
+
+bool ExifToolJsonDecoder::parseString(const char*& str, int& size, QByteArray& scratch)
+{
+    skipSpaces();
+
+    if (!expect('"'))
+    {
+        return false;
+    }
+
+    // Fast path: no escape sequence, the string is used in place.
+
+    const char* const start = m_pos;
+
+    while ((m_pos < m_end) && (*m_pos != '"') && (*m_pos != '\\'))
+    {
+        ++m_pos;
+    }
+
+    if (m_pos == m_end)
+    {
+        return fail("Unterminated string");
+    }
+
+    if (*m_pos == '"')
+    {
+        str  = start;
+        size = m_pos - start;
+        ++m_pos;
+
+        return true;
+    }
+
+    // Slow path: unescape in the scratch buffer.
+
+    scratch.clear();
+    scratch.append(start, m_pos - start);
+
+    while (m_pos < m_end)
+    {
+        const char c = *m_pos++;
+
+        if (c == '"')
+        {
+            str  = scratch.constData();
+            size = scratch.size();
+
+            return true;
+        }
+
+        if (c != '\\')
+        {
+            scratch.append(c);
+            continue;
+        }
+
+        if (m_pos == m_end)
+        {
+            break;
+        }
+
+        const char e = *m_pos++;
+
+        switch (e)
+        {
+            case 'b':
+                scratch.append('\b');
+                break;
+
+            case 'f':
+                scratch.append('\f');
+                break;
+
+            case 'n':
+                scratch.append('\n');
+                break;
+
+            case 'r':
+                scratch.append('\r');
+                break;
+
+            case 't':
+                scratch.append('\t');
+                break;
+
+            case 'u':
+            {
+                uint code = 0;
+
+                for (int i = 0 ; i < 4 ; ++i)
+                {
+                    const int h = (m_pos < m_end) ? hexValue(*m_pos++) : -1;
+
+                    if (h < 0)
+                    {
+                        return fail("Invalid unicode escape");
+                    }
+
+                    code = (code << 4) | h;
+                }
+
+                // Surrogate pair.
+
+                if ((code >= 0xD800) && (code < 0xDC00) && ((m_end - m_pos) >= 6) &&
+                    (m_pos[0] == '\\') && (m_pos[1] == 'u'))
+                {
+                    uint low = 0;
+                    bool ok  = true;
+
+                    for (int i = 2 ; i < 6 ; ++i)
+                    {
+                        const int h = hexValue(m_pos[i]);
+                        ok          = ok && (h >= 0);
+                        low         = (low << 4) | (uint)qMax(h, 0);
+                    }
+
+                    if (ok && (low >= 0xDC00) && (low < 0xE000))
+                    {
+                        code   = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        m_pos += 6;
+                    }
+                }
+
+                appendUtf8(scratch, code);
+                break;
+            }
+
+            default:
+                scratch.append(e);
+                break;
+        }
+    }
+
+    return fail("Unterminated string");
+}
+
+bool ExifToolJsonDecoder::parseValue(QString& value)
+{
+    skipSpaces();
+
+    if (m_pos == m_end)
+    {
+        return fail("Missing value");
+    }
+
+    if (*m_pos != '[')
+    {
+        return parseScalar(value);
+    }
+
+    // List value: join the items.
+
+    ++m_pos;
+    value.clear();
+
+    QString item;
+    bool first = true;
+
+    while (true)
+    {
+        skipSpaces();
+
+        if (m_pos == m_end)
+        {
+            return fail("Unterminated list");
+        }
+
+        if (*m_pos == ']')
+        {
+            ++m_pos;
+
+            return true;
+        }
+
+        if (!parseScalar(item))
+        {
+            return false;
+        }
+
+        if (!first)
+        {
+            value.append(QLatin1String(", "));
+        }
+
+        value.append(item);
+        first = false;
+
+        skipSpaces();
+
+        if ((m_pos < m_end) && (*m_pos == ','))
+        {
+            ++m_pos;
+        }
+    }
+}
+
+bool ExifToolJsonDecoder::parseScalar(QString& value)
+{
+    skipSpaces();
+
+    if (m_pos == m_end)
+    {
+        return fail("Missing value");
+    }
+
+    if (*m_pos == '"')
+    {
+        const char* str = nullptr;
+        int size        = 0;
+
+        if (!parseString(str, size, m_valueScratch))
+        {
+            return false;
+        }
+
+        value = QString::fromUtf8(str, size);
+
+        return true;
+    }
+
+    if ((*m_pos == '{') || (*m_pos == '['))
+    {
+        // Structures are not decoded.
+
+        value.clear();
+
+        return skipValue();
+    }
+
+    // Number, true, false or null: report the JSON text.
+
+    const char* const start = m_pos;
+
+    while ((m_pos < m_end) && !isDelimiter(*m_pos))
+    {
+        ++m_pos;
+    }
+
+    if (m_pos == start)
+    {
+        return fail("Invalid value");
+    }
+
+    if (((m_pos - start) == 4) && (memcmp(start, "null", 4) == 0))
+    {
+        value.clear();
+    }
+    else
+    {
+        value = QString::fromLatin1(start, m_pos - start);
+    }
+
+    return true;
+}
+
+bool ExifToolJsonDecoder::skipValue()
+{
+    skipSpaces();
+
+    int depth = 0;
+
+    while (m_pos < m_end)
+    {
+        const char c = *m_pos;
+
+        if (c == '"')
+        {
+            const char* str = nullptr;
+            int size        = 0;
+
+            if (!parseString(str, size, m_valueScratch))
+            {
+                return false;
+            }
+        }
+        else if ((c == '{') || (c == '['))
+        {
+            ++depth;
+            ++m_pos;
+        }
+        else if ((c == '}') || (c == ']'))
+        {
+            if (depth == 0)
+            {
+                return true;    // End of the enclosing container.
+            }
+
+            --depth;
+            ++m_pos;
+        }
+        else if ((c == ',') && (depth == 0))
+        {
+            return true;
+        }
+        else
+        {
+            ++m_pos;
+        }
+
+        if (depth == 0)
+        {
+            // A string, a complete container or the end of a scalar token was consumed.
+
+            if ((c == '"') || (c == '}') || (c == ']') || ((m_pos < m_end) && isDelimiter(*m_pos)))
+            {
+                return true;
+            }
+        }
+    }
+
+    return fail("Unterminated value");
+}
+
+void ExifToolJsonDecoder::skipSpaces()
+{
+    while ((m_pos < m_end) &&
+           ((*m_pos == ' ') || (*m_pos == '\n') || (*m_pos == '\r') || (*m_pos == '\t')))
+    {
+        ++m_pos;
+    }
+}
+
+bool ExifToolJsonDecoder::expect(char c)
+{
+    skipSpaces();
+
+    if ((m_pos == m_end) || (*m_pos != c))
+    {
+        return fail((c == '"') ? "Expected string" : "Unexpected character");
+    }
+
+    ++m_pos;
+
+    return true;
+}
+
+bool ExifToolJsonDecoder::fail(const char* const message)
+{
+    m_error = QString::fromLatin1("%1 at offset %2").arg(QLatin1String(message)).arg(m_pos - m_begin);
+
+    return false;
+}
+
+} // namespace Digikam
@@ -0,0 +1,120 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : single pass decoder of ExifTool JSON output.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_EXIFTOOL_JSON_DECODER_H
+#define DIGIKAM_EXIFTOOL_JSON_DECODER_H
+
+// Qt Core
+
+#include <QByteArray>
+#include <QString>
+
+namespace Digikam
+{
+
+/**
+ * Decoder of the output of ExifTool with -json, and optionally -l: an array of objects,
+ * one per file, with a SourceFile key and one key per tag. With -l, a tag value is
+ * an object holding the value in "val" and the description in "desc".
+ *
+ * The bytes are decoded in one pass, and each tag is reported to a Handler as soon as
+ * it is read, without building any intermediate document. List values are joined
+ * with ", ", numbers are reported with their JSON text.
+ */
+class ExifToolJsonDecoder
+{
+public:
+
+    class Handler
+    {
+    public:
+
+        virtual ~Handler()
+        {
+        }
+
+        /**
+         * Called when a new file object starts.
+         */
+        virtual void startFile()
+        {
+        }
+
+        virtual void sourceFile(const QString& path) = 0;
+
+        /**
+         * Called for each tag of the current file. The key bytes are only valid during the call.
+         */
+        virtual void tag(const char* const key,
+                         int keySize,
+                         const QString& value,
+                         const QString& description) = 0;
+
+        /**
+         * Called when the current file object is complete.
+         */
+        virtual void endFile()
+        {
+        }
+    };
+
+public:
+
+    explicit ExifToolJsonDecoder(Handler* const handler);
+    ~ExifToolJsonDecoder();
+
+    /**
+     * Decode a complete ExifTool JSON output. Return false on a syntax error,
+     * described by errorString(). Files reported before the error are kept by the handler.
+     */
+    bool    decode(const QByteArray& json);
+    bool    decode(const char* const data, int size);
+
+    QString errorString() const;
+
+private:
+
+    bool    parseFile();
+    bool    parseTag(const char* const key, int keySize);
+    bool    parseString(const char*& str, int& size, QByteArray& scratch);
+    bool    parseValue(QString& value);
+    bool    parseScalar(QString& value);
+    bool    skipValue();
+    void    skipSpaces();
+    bool    expect(char c);
+    bool    fail(const char* const message);
+
+private:
+
+    Handler*    m_handler;
+    const char* m_pos;
+    const char* m_end;
+    const char* m_begin;
+    QByteArray  m_keyScratch;           ///< Unescaped key, when it contains escape sequences.
+    QByteArray  m_valueScratch;         ///< Unescaped string value, when it contains escape sequences.
+    QString     m_error;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_EXIFTOOL_JSON_DECODER_H
@@ -0,0 +1,222 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : split ExifTool JSON output in per-file objects.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "exiftooljsonsplitter.h"
+
+namespace Digikam
+{
+
+ExifToolJsonSplitter::ExifToolJsonSplitter()
+    : m_depth   (0),
+      m_inString(false),
+      m_escape  (false)
+{
+}
+
+ExifToolJsonSplitter::~ExifToolJsonSplitter()
+{
+}
+
+void ExifToolJsonSplitter::reset()
+{
+    m_object.clear();
+    m_depth    = 0;
+    m_inString = false;
+    m_escape   = false;
+}
+
+QList<QByteArray> ExifToolJsonSplitter::feed(const QByteArray& data)
+{
+    QList<QByteArray> objects;
+    const char* const bytes = data.constData();
+    const int size          = data.size();
+    int start               = (m_depth >= 2) ? 0 : -1;       // Start of the current object in data.
+
+    for (int i = 0 ; i < size ; ++i)
+    {
+        const char c = bytes[i];
+
+        if (m_inString)
+        {
+            if      (m_escape)
+            {
+                m_escape = false;
+            }
+            else if (c == '\\')
+            {
+                m_escape = true;
+            }
+            else if (c == '"')
+            {
+                m_inString = false;
+            }
+
+            continue;
+        }
+
+        switch (c)
+        {
+            case '"':
+            {
+                m_inString = true;
+                break;
+            }
+
+            case '[':
+            case '{':
+            {
+                if ((m_depth == 1) && (c == '{'))
+                {
+                    start = i;
+                }
+
+                ++m_depth;
+                break;
+            }
+
+            case ']':
+            case '}':
+            {
+                if (m_depth > 0)
+                {
+                    --m_depth;
+                }
+
+                if ((m_depth == 1) && (c == '}') && (start != -1))
+                {
+                    m_object.append(bytes + start, i + 1 - start);
+                    objects << m_object;
+                    m_object.clear();
+                    start = -1;
+                }
+
+                break;
+            }
+
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    if ((start != -1) && (m_depth >= 2))
+    {
+        m_object.append(bytes + start, size - start);
+    }
+
+    return objects;
+}
+
+QList<QByteArray> ExifToolJsonSplitter::split(const QByteArray& json)
+{
+    ExifToolJsonSplitter splitter;
+
+    return splitter.feed(json);
+}
+
+QString ExifToolJsonSplitter::sourceFile(const QByteArray& object)
+{
+    static const QByteArray key("\"SourceFile\"");
+
+    int pos = object.indexOf(key);
+
+    if (pos == -1)
+    {
+        return QString();
+    }
+
+    pos = object.indexOf('"', pos + key.size());
+
+    if (pos == -1)
+    {
+        return QString();
+    }
+
+    // Decode the JSON string value. ExifTool only escapes quotes, backslashes and control characters.
+
+    QByteArray value;
+
+    for (int i = pos + 1 ; i < object.size() ; ++i)
+    {
+        const char c = object.at(i);
+
+        if (c == '"')
+        {
+            return QString::fromUtf8(value);
+        }
+
+        if ((c != '\\') || (i + 1 >= object.size()))
+        {
+            value.append(c);
+            continue;
+        }
+
+        const char e = object.at(++i);
+
+        switch (e)
+        {
+            case 'n':
+                value.append('\n');
+                break;
+
+            case 't':
+                value.append('\t');
+                break;
+
+            case 'r':
+                value.append('\r');
+                break;
+
+            case 'b':
+                value.append('\b');
+                break;
+
+            case 'f':
+                value.append('\f');
+                break;
+
+            case 'u':
+            {
+                bool ok          = false;
+                const ushort ch  = object.mid(i + 1, 4).toUShort(&ok, 16);
+
+                if (ok)
+                {
+                    value.append(QString(QChar(ch)).toUtf8());
+                    i += 4;
+                }
+
+                break;
+            }
+
+            default:
+                value.append(e);
+                break;
+        }
+    }
+
+    return QString();
+}
+
+} // namespace Digikam
@@ -0,0 +1,79 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : split ExifTool JSON output in per-file objects.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_EXIFTOOL_JSON_SPLITTER_H
+#define DIGIKAM_EXIFTOOL_JSON_SPLITTER_H
+
+// Qt Core
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+namespace Digikam
+{
+
+/**
+ * ExifTool -json output is an array with one object per file. This class extracts
+ * the objects as soon as they are complete, from data received in pieces of any size.
+ * Only the nesting is tracked, objects are not decoded.
+ */
+class ExifToolJsonSplitter
+{
+public:
+
+    ExifToolJsonSplitter();
+    ~ExifToolJsonSplitter();
+
+    /**
+     * Append data to the stream, and return the objects of the top level array
+     * completed by this data, in order.
+     */
+    QList<QByteArray> feed(const QByteArray& data);
+
+    /**
+     * Forget any incomplete object, to parse a new stream.
+     */
+    void reset();
+
+    /**
+     * Split a complete ExifTool JSON array.
+     */
+    static QList<QByteArray> split(const QByteArray& json);
+
+    /**
+     * Return the value of the SourceFile key of an object, or a null string.
+     */
+    static QString sourceFile(const QByteArray& object);
+
+private:
+
+    QByteArray m_object;            ///< Bytes of the current incomplete object.
+    int        m_depth;             ///< 0: outside of the array, 1: in the array, 2+: in an object.
+    bool       m_inString;
+    bool       m_escape;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_EXIFTOOL_JSON_SPLITTER_H
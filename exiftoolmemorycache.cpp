@@ -0,0 +1,384 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : in-memory cache of ExifTool parsed metadata.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "exiftoolmemorycache.h"
+
+// Qt includes
+
+#include <QHash>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+
+// Local includes
+
+#include "exiftooldiskcache.h"
+
+namespace Digikam
+{
+
+class Q_DECL_HIDDEN ExifToolMemoryCache::Private
+{
+public:
+
+    /**
+     * A cached result, linked in the list of its segment, most recently used first.
+     */
+    class Node
+    {
+    public:
+
+        Node()
+          : cost            (0),
+            protectedSegment(false),
+            prev            (nullptr),
+            next            (nullptr)
+        {
+        }
+
+        QByteArray                 key;
+        QByteArray                 fileKey;         ///< State of the file when it was parsed.
+        ExifToolParser::LoadResult result;
+        qint64                     cost;            ///< Memory used by the node, in bytes.
+        bool                       protectedSegment;
+        Node*                      prev;
+        Node*                      next;
+    };
+
+    class Segment
+    {
+    public:
+
+        Segment()
+          : head(nullptr),
+            tail(nullptr),
+            cost(0)
+        {
+        }
+
+        void pushFront(Node* const node)
+        {
+            node->prev = nullptr;
+            node->next = head;
+
+            if (head)
+            {
+                head->prev = node;
+            }
+            else
+            {
+                tail = node;
+            }
+
+            head  = node;
+            cost += node->cost;
+        }
+
+        void remove(Node* const node)
+        {
+            (node->prev ? node->prev->next : head) = node->next;
+            (node->next ? node->next->prev : tail) = node->prev;
+            node->prev = nullptr;
+            node->next = nullptr;
+            cost      -= node->cost;
+        }
+
+    public:
+
+        Node*  head;
+        Node*  tail;
+        qint64 cost;
+    };
+
+public:
+
+    explicit Private()
+      : maxMemory    (DEFAULT_MAX_MEMORY),
+        hits         (0),
+        misses       (0),
+        evictions    (0),
+        invalidations(0)
+    {
+    }
+
+    Segment& segment(const Node* const node)
+    {
+        return (node->protectedSegment ? protectedSegment : probation);
+    }
+
+    void drop(Node* const node)
+    {
+        segment(node).remove(node);
+        nodes.remove(node->key);
+        delete node;
+    }
+
+    /**
+     * Move the least recently used results of the protected segment over its share of the budget
+     * back to probation, then evict from probation until the budget is respected.
+     */
+    void evict()
+    {
+        const qint64 protectedMax = maxMemory * PROTECTED_PERCENT / 100;
+
+        while (protectedSegment.tail && (protectedSegment.cost > protectedMax))
+        {
+            Node* const node = protectedSegment.tail;
+            protectedSegment.remove(node);
+            node->protectedSegment = false;
+            probation.pushFront(node);
+        }
+
+        while ((probation.cost + protectedSegment.cost) > maxMemory)
+        {
+            Node* const node = probation.tail ? probation.tail : protectedSegment.tail;
+
+            if (!node)
+            {
+                break;
+            }
+
+            drop(node);
+            ++evictions;
+        }
+    }
+
+    static QByteArray key(const QString& path, const QByteArray& context)
+    {
+        return context + '\n' + QFileInfo(path).absoluteFilePath().toUtf8();
+    }
+
+public:
+
+    mutable QMutex           mutex;
+    QHash<QByteArray, Node*> nodes;
+    Segment                  probation;         ///< Results read once.
+    Segment                  protectedSegment;  ///< Results read again since they were cached.
+    qint64                   maxMemory;
+    quint64                  hits;
+    quint64                  misses;
+    quint64                  evictions;
+    quint64                  invalidations;
+
+public:
+
+    static const qint64      DEFAULT_MAX_MEMORY = 0;      ///< Disabled until setMaxMemory() is called.
+    static const int         PROTECTED_PERCENT  = 80;
+};
+
+ExifToolMemoryCache* ExifToolMemoryCache::instance()
+{
+    static ExifToolMemoryCache cache;
+
+    return &cache;
+}
+
+ExifToolMemoryCache::ExifToolMemoryCache()
+    : d(new Private)
+{
+}
+
+ExifToolMemoryCache::~ExifToolMemoryCache()
+{
+    clear();
+
+    delete d;
+}
+
+void ExifToolMemoryCache::setMaxMemory(qint64 bytes)
+{
+    QMutexLocker lock(&d->mutex);
+
+    d->maxMemory = qMax((qint64)0, bytes);
+    d->evict();
+}
+
+qint64 ExifToolMemoryCache::maxMemory() const
+{
+    QMutexLocker lock(&d->mutex);
+
+    return d->maxMemory;
+}
+
+bool ExifToolMemoryCache::isEnabled() const
+{
+    return (maxMemory() > 0);
+}
+
+bool ExifToolMemoryCache::lookup(const QString& path,
+                                 const QByteArray& context,
+                                 ExifToolParser::LoadResult& result)
+{
+    // The file is checked out of the lock.
+
+    const QByteArray key     = Private::key(path, context);
+    const QByteArray fileKey = ExifToolDiskCache::fileKey(path);
+
+    QMutexLocker lock(&d->mutex);
+
+    QHash<QByteArray, Private::Node*>::const_iterator it = d->nodes.constFind(key);
+
+    if (it == d->nodes.constEnd())
+    {
+        ++d->misses;
+
+        return false;
+    }
+
+    Private::Node* const node = it.value();
+
+    if (fileKey.isEmpty() || (node->fileKey != fileKey))
+    {
+        d->drop(node);
+        ++d->invalidations;
+        ++d->misses;
+
+        return false;
+    }
+
+    // A second read promotes the result to the protected segment.
+
+    d->segment(node).remove(node);
+    node->protectedSegment = true;
+    d->protectedSegment.pushFront(node);
+    d->evict();
+
+    ++d->hits;
+    result = node->result;
+
+    return true;
+}
+
+void ExifToolMemoryCache::insert(const QString& path,
+                                 const QByteArray& context,
+                                 const QByteArray& fileKey,
+                                 const ExifToolParser::LoadResult& result)
+{
+    if (!result.isValid() || fileKey.isEmpty())
+    {
+        return;
+    }
+
+    if (ExifToolDiskCache::fileKey(path) != fileKey)
+    {
+        return;
+    }
+
+    const QByteArray key = Private::key(path, context);
+
+    Private::Node* const node = new Private::Node;
+    node->key                 = key;
+    node->fileKey             = fileKey;
+    node->result              = result;
+    node->cost                = sizeof(Private::Node)                           +
+                                key.size() + fileKey.size()                     +
+                                result.path.size() * (qint64)sizeof(QChar)      +
+                                result.parsedTags.memoryUsage()                 +
+                                result.ignoredTags.memoryUsage();
+
+    QMutexLocker lock(&d->mutex);
+
+    // A result larger than the share of probation would evict everything for nothing.
+
+    if (node->cost > (d->maxMemory * (100 - Private::PROTECTED_PERCENT) / 100))
+    {
+        delete node;
+
+        return;
+    }
+
+    QHash<QByteArray, Private::Node*>::iterator it = d->nodes.find(key);
+
+    if (it != d->nodes.end())
+    {
+        d->drop(it.value());
+    }
+
+    d->nodes.insert(key, node);
+    d->probation.pushFront(node);
+    d->evict();
+}
+
+void ExifToolMemoryCache::clear()
+{
+    QMutexLocker lock(&d->mutex);
+
+    qDeleteAll(d->nodes);
+    d->nodes.clear();
+    d->probation        = Private::Segment();
+    d->protectedSegment = Private::Segment();
+}
+
+qint64 ExifToolMemoryCache::memoryUsage() const
+{
+    QMutexLocker lock(&d->mutex);
+
+    return (d->probation.cost + d->protectedSegment.cost);
+}
+
+int ExifToolMemoryCache::count() const
+{
+    QMutexLocker lock(&d->mutex);
+
+    return d->nodes.size();
+}
+
+quint64 ExifToolMemoryCache::hits() const
+{
+    QMutexLocker lock(&d->mutex);
+
+    return d->hits;
+}
+
+quint64 ExifToolMemoryCache::misses() const
+{
+    QMutexLocker lock(&d->mutex);
+
+    return d->misses;
+}
+
+quint64 ExifToolMemoryCache::evictions() const
+{
+    QMutexLocker lock(&d->mutex);
+
+    return d->evictions;
+}
+
+quint64 ExifToolMemoryCache::invalidations() const
+{
+    QMutexLocker lock(&d->mutex);
+
+    return d->invalidations;
+}
+
+void ExifToolMemoryCache::resetCounters()
+{
+    QMutexLocker lock(&d->mutex);
+
+    d->hits          = 0;
+    d->misses        = 0;
+    d->evictions     = 0;
+    d->invalidations = 0;
+}
+
+} // namespace Digikam
@@ -0,0 +1,117 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : in-memory cache of ExifTool parsed metadata.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_EXIFTOOL_MEMORY_CACHE_H
+#define DIGIKAM_EXIFTOOL_MEMORY_CACHE_H
+
+// Qt Core
+
+#include <QString>
+#include <QByteArray>
+
+// Local includes
+
+#include "exiftoolparser.h"
+
+namespace Digikam
+{
+
+/**
+ * Process-wide cache of the metadata recently parsed from files, shared by all parsers,
+ * under a memory budget in bytes.
+ *
+ * Eviction is segmented LRU: a new result enters a probation segment, and moves to a protected
+ * segment, holding up to 80% of the budget, when it is read again. A file read once, as during
+ * a collection scan, does not evict the results used repeatedly.
+ *
+ * A lookup checks the size, modification time and inode of the file: a changed file is a miss.
+ * All functions are thread-safe.
+ */
+class ExifToolMemoryCache
+{
+public:
+
+    static ExifToolMemoryCache* instance();
+
+    /**
+     * Set the memory budget, in bytes. Results are evicted until the budget is respected.
+     * 0 disables the cache, which is the default: as setCacheFile() for the disk cache,
+     * the memory cache is only used when the application asks for it, e.g. with 32 MiB.
+     */
+    void   setMaxMemory(qint64 bytes);
+    qint64 maxMemory()                                                  const;
+    bool   isEnabled()                                                  const;
+
+    /**
+     * Read the result of a file loaded with a context, as defined by ExifToolDiskCache.
+     * Return false on a miss.
+     */
+    bool   lookup(const QString& path,
+                  const QByteArray& context,
+                  ExifToolParser::LoadResult& result);
+
+    /**
+     * Store the result of a file loaded with a context. fileKey is the state of the file
+     * taken before it was loaded, see ExifToolDiskCache::fileKey(): the result is dropped
+     * if the file changed since.
+     */
+    void   insert(const QString& path,
+                  const QByteArray& context,
+                  const QByteArray& fileKey,
+                  const ExifToolParser::LoadResult& result);
+
+    void   clear();
+
+    /**
+     * Return the memory used by the cached results, in bytes.
+     */
+    qint64 memoryUsage()                                                const;
+    int    count()                                                      const;
+
+    /**
+     * Counters since the creation of the cache or the last resetCounters().
+     */
+    quint64 hits()                                                      const;
+    quint64 misses()                                                    const;
+    quint64 evictions()                                                 const;
+    quint64 invalidations()                                             const;  ///< Entries dropped because the file changed.
+    void    resetCounters();
+
+private:
+
+    ExifToolMemoryCache();
+    ~ExifToolMemoryCache();
+
+    // Disable
+    ExifToolMemoryCache(const ExifToolMemoryCache&)            = delete;
+    ExifToolMemoryCache& operator=(const ExifToolMemoryCache&) = delete;
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_EXIFTOOL_MEMORY_CACHE_H
@@ -0,0 +1,207 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : tests of the in-memory cache of parsed metadata.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+// Qt includes
+
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QStringList>
+#include <QDebug>
+
+// Local includes
+
+#include "exiftoolmemorycache.h"
+#include "exiftooldiskcache.h"
+
+using namespace Digikam;
+
+namespace
+{
+
+#define CHECK(condition)                                                          \
+    if (!(condition))                                                             \
+    {                                                                             \
+        qWarning() << "Check failed at line" << __LINE__ << ":" << #condition;    \
+        return false;                                                             \
+    }
+
+static const QByteArray CONTEXT("test");
+
+QString createFile(const QTemporaryDir& dir, int index)
+{
+    const QString path = dir.filePath(QString::fromLatin1("file%1.jpg").arg(index, 3, 10, QLatin1Char('0')));
+    QFile file(path);
+
+    if (file.open(QIODevice::WriteOnly))
+    {
+        file.write("data");
+    }
+
+    return path;
+}
+
+ExifToolParser::LoadResult result(const QString& path)
+{
+    ExifToolParser::LoadResult res;
+    res.path = path;
+
+    return res;
+}
+
+void insert(const QString& path)
+{
+    ExifToolMemoryCache::instance()->insert(path, CONTEXT, ExifToolDiskCache::fileKey(path), result(path));
+}
+
+bool contains(const QString& path)
+{
+    ExifToolParser::LoadResult res;
+
+    return ExifToolMemoryCache::instance()->lookup(path, CONTEXT, res);
+}
+
+/**
+ * The cache is disabled by default: nothing is stored.
+ */
+bool testDisabledByDefault(const QTemporaryDir& dir)
+{
+    ExifToolMemoryCache* const cache = ExifToolMemoryCache::instance();
+    const QString path               = createFile(dir, 0);
+
+    CHECK(!cache->isEnabled());
+
+    insert(path);
+
+    CHECK(cache->count() == 0);
+    CHECK(!contains(path));
+
+    return true;
+}
+
+/**
+ * A result read again is protected: a scan of files read once evicts the oldest of them, not it.
+ */
+bool testScanResistance(const QTemporaryDir& dir)
+{
+    ExifToolMemoryCache* const cache = ExifToolMemoryCache::instance();
+
+    // Measure the cost of one result to size the budget at about 10 results.
+
+    cache->setMaxMemory(1024 * 1024);
+    const QString hot = createFile(dir, 1);
+    insert(hot);
+    const qint64 cost = cache->memoryUsage();
+    CHECK(cost > 0);
+
+    cache->setMaxMemory(cost * 10);
+    cache->resetCounters();
+
+    CHECK(contains(hot));                           // Promoted to the protected segment.
+    CHECK(cache->hits() == 1);
+
+    QStringList scanned;
+
+    for (int i = 0 ; i < 30 ; ++i)
+    {
+        scanned << createFile(dir, 100 + i);
+        insert(scanned.last());
+    }
+
+    CHECK(cache->memoryUsage() <= cost * 10);
+    CHECK(cache->evictions() >= 15);
+    CHECK(contains(hot));
+    CHECK(contains(scanned.last()));
+    CHECK(!contains(scanned.first()));
+    CHECK(cache->hits()   == 3);
+    CHECK(cache->misses() == 1);
+
+    cache->resetCounters();
+
+    CHECK((cache->hits() == 0) && (cache->misses() == 0) && (cache->evictions() == 0));
+
+    return true;
+}
+
+/**
+ * A changed file is a miss, and a result of a file changed while it was loaded is not stored.
+ */
+bool testInvalidation(const QTemporaryDir& dir)
+{
+    ExifToolMemoryCache* const cache = ExifToolMemoryCache::instance();
+    cache->setMaxMemory(1024 * 1024);
+    cache->clear();
+    cache->resetCounters();
+
+    const QString path = createFile(dir, 2);
+    insert(path);
+    CHECK(contains(path));
+
+    QFile file(path);
+    CHECK(file.open(QIODevice::Append));
+    file.write("more data");
+    file.close();
+
+    CHECK(!contains(path));
+    CHECK(cache->invalidations() == 1);
+    CHECK(cache->count() == 0);
+
+    // State taken before the change: the result is dropped.
+
+    const QByteArray staleKey = ExifToolDiskCache::fileKey(path);
+
+    CHECK(file.open(QIODevice::Append));
+    file.write("even more data");
+    file.close();
+
+    cache->insert(path, CONTEXT, staleKey, result(path));
+
+    CHECK(cache->count() == 0);
+    CHECK(!contains(path));
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QTemporaryDir dir;
+
+    if (!dir.isValid())
+    {
+        qWarning() << "Cannot create a temporary directory";
+        return 1;
+    }
+
+    if (!testDisabledByDefault(dir) || !testScanResistance(dir) || !testInvalidation(dir))
+    {
+        qWarning() << "FAIL: ExifToolMemoryCache";
+        return 1;
+    }
+
+    qDebug() << "PASS: ExifToolMemoryCache";
+
+    return 0;
+}
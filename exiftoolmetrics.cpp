@@ -0,0 +1,279 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : latency histograms and counters of ExifTool processing.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "exiftoolmetrics.h"
+
+// C++ includes
+
+#include <cstring>
+
+// Qt includes
+
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QDateTime>
+#include <QDebug>
+
+namespace Digikam
+{
+
+ExifToolMetrics::Snapshot::Snapshot()
+{
+    memset(counters, 0, sizeof(counters));
+    memset(buckets,  0, sizeof(buckets));
+    memset(sums,     0, sizeof(sums));
+    memset(maxima,   0, sizeof(maxima));
+}
+
+qint64 ExifToolMetrics::Snapshot::counter(Counter counter) const
+{
+    return counters[counter];
+}
+
+qint64 ExifToolMetrics::Snapshot::count(Histogram histogram) const
+{
+    qint64 total = 0;
+
+    for (int i = 0 ; i < NB_BUCKETS ; ++i)
+    {
+        total += buckets[histogram][i];
+    }
+
+    return total;
+}
+
+qint64 ExifToolMetrics::Snapshot::mean(Histogram histogram) const
+{
+    const qint64 total = count(histogram);
+
+    return (total ? (sums[histogram] / total) : 0);
+}
+
+qint64 ExifToolMetrics::Snapshot::maximum(Histogram histogram) const
+{
+    return maxima[histogram];
+}
+
+qint64 ExifToolMetrics::Snapshot::percentile(Histogram histogram, double p) const
+{
+    const qint64 total = count(histogram);
+
+    if (!total)
+    {
+        return 0;
+    }
+
+    const qint64 rank = qMax((qint64)1, (qint64)(qBound(0.0, p, 1.0) * total + 0.5));
+    qint64 seen       = 0;
+
+    for (int i = 0 ; i < NB_BUCKETS ; ++i)
+    {
+        seen += buckets[histogram][i];
+
+        if (seen >= rank)
+        {
+            return qMin(((qint64)1 << (i + 1)) - 1, maxima[histogram]);
+        }
+    }
+
+    return maxima[histogram];
+}
+
+QString ExifToolMetrics::Snapshot::name(Histogram histogram)
+{
+    switch (histogram)
+    {
+        case QueueWait:
+            return QLatin1String("queue wait");
+
+        case TimeToFirstByte:
+            return QLatin1String("time to first byte");
+
+        case Execution:
+            return QLatin1String("execution");
+
+        case JsonParse:
+            return QLatin1String("json parse");
+
+        default:
+            return QString();
+    }
+}
+
+QString ExifToolMetrics::Snapshot::name(Counter counter)
+{
+    switch (counter)
+    {
+        case Commands:
+            return QLatin1String("commands");
+
+        case FailedCommands:
+            return QLatin1String("failed commands");
+
+        case StdOutBytes:
+            return QLatin1String("stdout bytes");
+
+        case StdErrBytes:
+            return QLatin1String("stderr bytes");
+
+        case Restarts:
+            return QLatin1String("restarts");
+
+        case SyncErrors:
+            return QLatin1String("sync errors");
+
+        case Timeouts:
+            return QLatin1String("timeouts");
+
+        default:
+            return QString();
+    }
+}
+
+QString ExifToolMetrics::Snapshot::toString() const
+{
+    QString report;
+    QTextStream stream(&report);
+
+    stream << "ExifTool metrics at " << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n";
+
+    for (int c = 0 ; c < NbCounters ; ++c)
+    {
+        stream << "  " << name((Counter)c).leftJustified(20) << counters[c] << "\n";
+    }
+
+    stream << "  Durations in microseconds:   count       mean        p50        p90        p99        max\n";
+
+    for (int h = 0 ; h < NbHistograms ; ++h)
+    {
+        const Histogram histogram = (Histogram)h;
+
+        stream << "  " << name(histogram).leftJustified(25)
+               << QString::number(count(histogram)).rightJustified(10)
+               << QString::number(mean(histogram)).rightJustified(11)
+               << QString::number(percentile(histogram, 0.50)).rightJustified(11)
+               << QString::number(percentile(histogram, 0.90)).rightJustified(11)
+               << QString::number(percentile(histogram, 0.99)).rightJustified(11)
+               << QString::number(maximum(histogram)).rightJustified(11)
+               << "\n";
+    }
+
+    stream.flush();
+
+    return report;
+}
+
+bool ExifToolMetrics::Snapshot::dump(const QString& filePath) const
+{
+    QFile file;
+
+    if (filePath.isEmpty())
+    {
+        if (!file.open(stdout, QIODevice::WriteOnly))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        file.setFileName(filePath);
+
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        {
+            qWarning() << "ExifToolMetrics: cannot write metrics to" << filePath;
+            return false;
+        }
+    }
+
+    const QByteArray report = toString().toUtf8();
+
+    return (file.write(report) == report.size());
+}
+
+// -----------------------------------------------------------------------------------------------
+
+class Q_DECL_HIDDEN ExifToolMetrics::Private
+{
+public:
+
+    explicit Private()
+    {
+    }
+
+public:
+
+    mutable QMutex mutex;
+    Snapshot       values;
+};
+
+ExifToolMetrics::ExifToolMetrics()
+    : d(new Private)
+{
+}
+
+ExifToolMetrics::~ExifToolMetrics()
+{
+    delete d;
+}
+
+void ExifToolMetrics::record(Histogram histogram, qint64 usecs)
+{
+    usecs      = qMax((qint64)0, usecs);
+    int bucket = 0;
+
+    while ((bucket < (NB_BUCKETS - 1)) && (((qint64)2 << bucket) <= usecs))
+    {
+        ++bucket;
+    }
+
+    QMutexLocker lock(&d->mutex);
+
+    d->values.buckets[histogram][bucket]++;
+    d->values.sums[histogram]      += usecs;
+    d->values.maxima[histogram]     = qMax(d->values.maxima[histogram], usecs);
+}
+
+void ExifToolMetrics::increment(Counter counter, qint64 value)
+{
+    QMutexLocker lock(&d->mutex);
+
+    d->values.counters[counter] += value;
+}
+
+ExifToolMetrics::Snapshot ExifToolMetrics::snapshot() const
+{
+    QMutexLocker lock(&d->mutex);
+
+    return d->values;
+}
+
+void ExifToolMetrics::reset()
+{
+    QMutexLocker lock(&d->mutex);
+
+    d->values = Snapshot();
+}
+
+} // namespace Digikam
@@ -0,0 +1,135 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : latency histograms and counters of ExifTool processing.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_EXIFTOOL_METRICS_H
+#define DIGIKAM_EXIFTOOL_METRICS_H
+
+// Qt Core
+
+#include <QString>
+#include <QtGlobal>
+
+namespace Digikam
+{
+
+/**
+ * Metrics recorded by an ExifToolProcess and the parsers using it. Durations are recorded
+ * in microseconds in histograms with power of two buckets, so recording is constant time
+ * and memory does not grow. All functions are thread-safe.
+ */
+class ExifToolMetrics
+{
+public:
+
+    enum Histogram
+    {
+        QueueWait = 0,                  ///< From command() to the write to ExifTool.
+        TimeToFirstByte,                ///< From the start of the execution to the first output.
+        Execution,                      ///< From the start of the execution to the completion.
+        JsonParse,                      ///< Decoding of the output by the parser.
+        NbHistograms
+    };
+
+    enum Counter
+    {
+        Commands = 0,                   ///< Completed commands.
+        FailedCommands,                 ///< Commands reported with signalCmdFailed().
+        StdOutBytes,                    ///< Bytes read from the standard output channel.
+        StdErrBytes,                    ///< Bytes read from the standard error channel.
+        Restarts,                       ///< Process restarts after a timeout, a cancellation or a crash.
+        SyncErrors,                     ///< Outputs out of sync with the commands.
+        Timeouts,                       ///< Commands which exceeded their timeout.
+        NbCounters
+    };
+
+    static const int NB_BUCKETS = 32;   ///< Bucket i holds durations in [2^i, 2^(i+1)) microseconds.
+
+    /**
+     * Values of all metrics at a point in time.
+     */
+    class Snapshot
+    {
+    public:
+
+        Snapshot();
+
+        qint64  counter(Counter counter)                       const;
+
+        qint64  count(Histogram histogram)                     const;
+        qint64  mean(Histogram histogram)                      const;
+        qint64  maximum(Histogram histogram)                   const;
+
+        /**
+         * Return an upper bound of the given percentile (0.0 to 1.0) of a histogram, in microseconds.
+         * The precision is the bucket width, i.e. a factor 2.
+         */
+        qint64  percentile(Histogram histogram, double p)      const;
+
+        /**
+         * Return a human readable report of all metrics.
+         */
+        QString toString()                                     const;
+
+        /**
+         * Write the report to a file, or to the standard output if filePath is empty.
+         * Return false if the file cannot be written.
+         */
+        bool    dump(const QString& filePath = QString())      const;
+
+        static QString name(Histogram histogram);
+        static QString name(Counter counter);
+
+    public:
+
+        qint64  counters[NbCounters];
+        qint64  buckets[NbHistograms][NB_BUCKETS];
+        qint64  sums[NbHistograms];
+        qint64  maxima[NbHistograms];
+    };
+
+public:
+
+    ExifToolMetrics();
+    ~ExifToolMetrics();
+
+    void     record(Histogram histogram, qint64 usecs);
+    void     increment(Counter counter, qint64 value = 1);
+
+    Snapshot snapshot()                                        const;
+    void     reset();
+
+private:
+
+    // Disable
+    ExifToolMetrics(const ExifToolMetrics&)            = delete;
+    ExifToolMetrics& operator=(const ExifToolMetrics&) = delete;
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_EXIFTOOL_METRICS_H
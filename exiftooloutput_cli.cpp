@@ -37,14 +37,80 @@
 
 using namespace Digikam;
 
+/**
+ * Print the files of a directory tree as they are read by ExifTool, with their number of tags.
+ */
+int scanDirectory(QCoreApplication& app, const QString& dirPath, const QStringList& extensions)
+{
+    ExifToolParser* const parser = new ExifToolParser();
+    parser->setTranslations(false);
+
+    int status = 0;
+
+    QObject::connect(parser, &ExifToolParser::signalScanResult,
+                     [](int, const ExifToolParser::LoadResult& result)
+        {
+            if (result.isValid())
+            {
+                qDebug().noquote() << result.path << ":" << result.parsedTags.size() << "tags";
+            }
+            else
+            {
+                qDebug().noquote() << result.path << ":" << result.errorString;
+            }
+        }
+    );
+
+    QObject::connect(parser, &ExifToolParser::signalScanFinished,
+                     [&app, &status](int, int files, const QString& errorString)
+        {
+            qDebug().noquote() << files << "files read";
+
+            if (!errorString.isEmpty())
+            {
+                qDebug().noquote() << errorString;
+                status = -1;
+            }
+
+            app.quit();
+        }
+    );
+
+    if (!parser->scanDirectory(dirPath, extensions))
+    {
+        delete parser;
+
+        return -1;
+    }
+
+    app.exec();
+
+    delete parser;
+
+    return status;
+}
+
 int main(int argc, char** argv)
 {
     QCoreApplication app(argc, argv);
 
+    if ((argc >= 3) && (QString::fromUtf8(argv[1]) == QLatin1String("-r")))
+    {
+        QStringList extensions;
+
+        for (int i = 3 ; i < argc ; ++i)
+        {
+            extensions << QString::fromUtf8(argv[i]);
+        }
+
+        return scanDirectory(app, QString::fromUtf8(argv[2]), extensions);
+    }
+
     if (argc != 2)
     {
         qDebug() << "exiftooloutpu_cli - CLI tool to print ExifTool output without Exiv2 translation";
         qDebug() << "Usage: <image>";
+        qDebug() << "       -r <directory> [extensions...]";
         return -1;
     }
 
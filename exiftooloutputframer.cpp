@@ -0,0 +1,206 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : frame the output of ExifTool commands between sentinels.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "exiftooloutputframer.h"
+
+// C++ includes
+
+#include <cstring>
+
+namespace Digikam
+{
+
+ExifToolOutputFramer::ExifToolOutputFramer()
+    : cmdId       (0),
+      payloadStart(0),
+      scanPos     (0)
+{
+}
+
+ExifToolOutputFramer::~ExifToolOutputFramer()
+{
+}
+
+void ExifToolOutputFramer::clear()
+{
+    buffer.clear();
+    done.clear();
+    chunks.clear();
+    cmdId        = 0;
+    payloadStart = 0;
+    scanPos      = 0;
+}
+
+bool ExifToolOutputFramer::hasOutput(int cmdId) const
+{
+    return (done.contains(cmdId) || ((cmdId == this->cmdId) && (buffer.size() > payloadStart)));
+}
+
+void ExifToolOutputFramer::scan()
+{
+    const char* const data = buffer.constData();
+    const int size         = buffer.size();
+    int pos                = scanPos;
+    int consumed           = cmdId ? payloadStart : scanPos;
+
+    while (pos < size)
+    {
+        if (!cmdId)
+        {
+            // Skip lines until the {await<id>} sentinel announcing the next command.
+
+            const char* const eol = static_cast<const char*>(memchr(data + pos, '\n', size - pos));
+
+            if (!eol)
+            {
+                break;
+            }
+
+            const int lineEnd = eol - data;
+            int len           = lineEnd - pos;
+
+            if (len && (data[lineEnd - 1] == '\r'))
+            {
+                --len;
+            }
+
+            if ((len > 7) && (memcmp(data + pos, "{await", 6) == 0) && (data[pos + len - 1] == '}'))
+            {
+                cmdId        = QByteArray::fromRawData(data + pos + 6, len - 7).toInt();
+                payloadStart = lineEnd + 1;
+            }
+
+            pos      = lineEnd + 1;
+            consumed = pos;
+
+            continue;
+        }
+
+        // Look for the {ready} sentinel closing the payload. Only '{' characters are candidates.
+
+        const char* const brace = static_cast<const char*>(memchr(data + pos, '{', size - pos));
+
+        if (!brace)
+        {
+            pos = size;
+            flush(data, pos);
+            break;
+        }
+
+        const int start = brace - data;
+
+        if ((size - start) < 8)
+        {
+            pos = start;    // Sentinel can be incomplete, search again from here with the next chunk.
+            flush(data, pos);
+            break;
+        }
+
+        if (memcmp(brace, "{ready}", 7) != 0)
+        {
+            pos = start + 1;
+            continue;
+        }
+
+        int end = start + 7;
+
+        if (data[end] == '\r')
+        {
+            if ((end + 1) >= size)
+            {
+                pos = start;
+                flush(data, pos);
+                break;
+            }
+
+            ++end;
+        }
+
+        if (data[end] != '\n')
+        {
+            pos = start + 1;
+            continue;
+        }
+
+        if (streamIds.contains(cmdId))
+        {
+            flush(data, start);
+            done.insert(cmdId, QByteArray());
+        }
+        else
+        {
+            QByteArray payload(data + payloadStart, start - payloadStart);
+
+#ifdef Q_OS_WIN
+
+            payload.replace("\r\n", "\n");
+
+#endif
+
+            done.insert(cmdId, payload);
+        }
+
+        cmdId    = 0;
+        pos      = end + 1;
+        consumed = pos;
+    }
+
+    // Drop consumed bytes, keeping the current payload and a possible incomplete sentinel.
+
+    if (cmdId && streamIds.contains(cmdId))
+    {
+        consumed = payloadStart;
+    }
+
+    if (consumed >= size)
+    {
+        buffer.clear();
+        payloadStart = 0;
+        scanPos      = 0;
+    }
+    else if (consumed > 0)
+    {
+        buffer.remove(0, consumed);
+        payloadStart = cmdId ? (payloadStart - consumed) : 0;
+        scanPos      = pos - consumed;
+    }
+    else
+    {
+        scanPos      = pos;
+    }
+}
+
+void ExifToolOutputFramer::flush(const char* const data, int end)
+{
+    // Bytes before end cannot belong to a sentinel: deliver them as a chunk of the streamed payload.
+
+    if (!cmdId || !streamIds.contains(cmdId) || (end <= payloadStart))
+    {
+        return;
+    }
+
+    chunks.append(qMakePair(cmdId, QByteArray(data + payloadStart, end - payloadStart)));
+    payloadStart = end;
+}
+
+} // namespace Digikam
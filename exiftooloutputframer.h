@@ -0,0 +1,82 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : frame the output of ExifTool commands between sentinels.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_EXIFTOOL_OUTPUT_FRAMER_H
+#define DIGIKAM_EXIFTOOL_OUTPUT_FRAMER_H
+
+// Qt Core
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QPair>
+
+namespace Digikam
+{
+
+/**
+ * Framing state of one output channel of ExifTool. Raw bytes are read from the pipe in large chunks
+ * and scanned in place for the {await<id>} and {ready} sentinels which surround
+ * the output of each command. A payload is copied once, when its frame is complete.
+ */
+class ExifToolOutputFramer
+{
+public:
+
+    ExifToolOutputFramer();
+    ~ExifToolOutputFramer();
+
+    void clear();
+
+    /**
+     * Move all complete frames found in buffer to done, and drop the consumed bytes.
+     */
+    void scan();
+
+    /**
+     * Return true if some output of the command cmdId was received.
+     */
+    bool hasOutput(int cmdId) const;
+
+public:
+
+    QByteArray             buffer;                  ///< Bytes read from the pipe and not yet consumed.
+    int                    cmdId;                   ///< Command id announced by the last {await} sentinel, or 0.
+    int                    payloadStart;            ///< Position of the cmdId payload in buffer.
+    int                    scanPos;                 ///< Position in buffer where the next sentinel search starts.
+    QHash<int, QByteArray> done;                    ///< Completed payloads by command id.
+    QSet<int>              streamIds;               ///< Commands which payload is delivered by chunks.
+    QList<QPair<int, QByteArray> > chunks;          ///< Payload chunks of streamed commands, not yet delivered.
+
+private:
+
+    /**
+     * Move the payload of a streamed command, up to end position in buffer, to chunks.
+     */
+    void flush(const char* const data, int end);
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_EXIFTOOL_OUTPUT_FRAMER_H
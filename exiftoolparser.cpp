@@ -27,16 +27,30 @@
 
 #include <QDir>
 #include <QFileInfo>
+#include <QStandardPaths>
 #include <QVariant>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
 #include <QEventLoop>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QFutureInterface>
+#include <QSharedPointer>
+#include <QPointer>
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
 #include <QDebug>
 
 // Local includes
 
 #include "exiftoolprocess.h"
+#include "exiftoolpool.h"
+#include "exiftooljsondecoder.h"
+#include "exiftooljsonsplitter.h"
+#include "exiftooltagdictionary.h"
+#include "exiftooltranslator.h"
+#include "exiftooldiskcache.h"
+#include "exiftoolmemorycache.h"
 
 namespace Digikam
 {
@@ -46,237 +60,1417 @@ class Q_DECL_HIDDEN ExifToolParser::Private
 public:
 
     explicit Private()
-      : translate(true),
-        proc     (nullptr),
-        loop     (nullptr)
+      : translate   (true),
+        proc        (nullptr),
+        timeout     (DEFAULT_TIMEOUT),
+        batchSize   (DEFAULT_BATCH_SIZE),
+        pool        (nullptr),
+        diskCache   (nullptr),
+        versionCmdId(0)
     {
     }
 
-    bool             translate;
-    ExifToolProcess* proc;
-    QEventLoop*      loop;
-    QString          parsedPath;
-    TagsMap          parsedMap;
-    TagsMap          ignoredMap;
+    /**
+     * Complete a pending load with an error.
+     */
+    static void fail(QFutureInterface<LoadResult>& promise, const QString& error)
+    {
+        LoadResult result;
+        result.errorString = error;
+        promise.reportResult(result);
+        promise.reportFinished();
+    }
+
+    /**
+     * Receive the tags decoded from the JSON output of a load, one result per file.
+     */
+    class LoadHandler : public ExifToolJsonDecoder::Handler
+    {
+    public:
+
+        LoadHandler(const ExifToolParser* const parser,
+                    const ExifToolProjection& projection,
+                    QList<LoadResult>& results)
+          : m_parser    (parser),
+            m_projection(projection),
+            m_results   (results)
+        {
+        }
+
+        void startFile() override
+        {
+            m_results.append(LoadResult());
+        }
+
+        void sourceFile(const QString& path) override
+        {
+            m_results.last().path = path;
+        }
+
+        void tag(const char* const key, int keySize, const QString& value, const QString& description) override
+        {
+            m_parser->parseTag(key, keySize, value, description, m_projection, m_results.last());
+        }
+
+        void endFile() override
+        {
+            m_results.last().parsedTags.squeeze();
+            m_results.last().ignoredTags.squeeze();
+        }
+
+    private:
+
+        const ExifToolParser*     m_parser;
+        const ExifToolProjection& m_projection;
+        QList<LoadResult>&        m_results;
+    };
+
+    /**
+     * A list of files loaded by loadBatchAsync().
+     */
+    class Batch
+    {
+    public:
+
+        Batch()
+          : remaining(0),
+            done     (0)
+        {
+        }
+
+        QFutureInterface<LoadResult> promise;
+        ExifToolProjection           projection;
+        QByteArray                   cacheContext;
+        int                          remaining;         ///< Number of files not yet reported.
+        int                          done;
+    };
+
+    /**
+     * Files of a batch sent to ExifTool in one command.
+     */
+    class BatchChunk
+    {
+    public:
+
+        BatchChunk()
+          : first(0)
+        {
+        }
+
+        QSharedPointer<Batch> batch;
+        int                   first;                    ///< Index of the first file in the batch.
+        QStringList           paths;                    ///< Files as sent to ExifTool.
+        QList<QByteArray>     fileKeys;                 ///< State of the files when they were sent, to cache their results.
+    };
+
+    /**
+     * A load to cache when it completes. The state of the file is taken when the load is sent:
+     * a file changed while ExifTool reads it is not cached.
+     */
+    class CacheMiss
+    {
+    public:
+
+        QString    path;
+        QByteArray context;
+        QByteArray fileKey;                             ///< See ExifToolDiskCache::fileKey().
+    };
+
+    /**
+     * A directory tree read by scanDirectory(). Only the current incomplete JSON object is kept in memory.
+     */
+    class Scan
+    {
+    public:
+
+        Scan()
+          : proc (nullptr),
+            files(0)
+        {
+        }
+
+        ExifToolProcess*     proc;                      ///< Dedicated to the scan, owned by the parser.
+        ExifToolJsonSplitter splitter;
+        ExifToolProjection   projection;
+        int                  files;                     ///< Number of files reported.
+    };
+
+    /**
+     * Stop the process of a finished or cancelled scan. It is destroyed when it exits.
+     */
+    static void releaseScan(QObject* const receiver, const Scan& scan, bool killProcess)
+    {
+        QObject::disconnect(scan.proc, nullptr, receiver, nullptr);
+
+        if (scan.proc->state() == QProcess::NotRunning)
+        {
+            scan.proc->deleteLater();
+
+            return;
+        }
+
+        QObject::connect(scan.proc, &ExifToolProcess::signalFinished,
+                         scan.proc, &QObject::deleteLater);
+
+        if (killProcess)
+        {
+            scan.proc->kill();
+        }
+        else
+        {
+            scan.proc->terminate();
+        }
+    }
+
+    /**
+     * Report the results of files of a batch, by index, and finish the batch with its last file.
+     */
+    static void reportBatch(Batch& batch, int index, const LoadResult& result)
+    {
+        batch.promise.reportResult(result, index);
+        batch.promise.setProgressValue(++batch.done);
+
+        if (--batch.remaining == 0)
+        {
+            batch.promise.reportFinished();
+        }
+    }
+
+    static void failChunk(const BatchChunk& chunk, const QString& error)
+    {
+        for (int i = 0 ; i < chunk.paths.size() ; ++i)
+        {
+            LoadResult result;
+            result.errorString = error;
+            reportBatch(*chunk.batch, chunk.first + i, result);
+        }
+    }
+
+    /**
+     * Receive the value of the tag read by a binary fetch.
+     */
+    class BinaryHandler : public ExifToolJsonDecoder::Handler
+    {
+    public:
+
+        BinaryHandler()
+          : found(false)
+        {
+        }
+
+        void sourceFile(const QString& /*path*/) override
+        {
+        }
+
+        void tag(const char* const /*key*/, int /*keySize*/, const QString& value, const QString& /*description*/) override
+        {
+            if (!found)
+            {
+                data  = value;
+                found = true;
+            }
+        }
+
+    public:
+
+        QString data;
+        bool    found;
+    };
+
+    /**
+     * Options of the command reading metadata from a file as a JSON array, serialized once for all loads.
+     * Without -binary, ExifTool prints a placeholder with the size of binary tags instead of their data.
+     */
+    static const ExifToolCommandTemplate& loadCommand()
+    {
+        static const ExifToolCommandTemplate cmd(QByteArrayList() << QByteArray("-json")
+                                                                  << QByteArray("-G:0:1:2:4:6")
+                                                                  << QByteArray("-n")
+                                                                  << QByteArray("-l"));
+
+        return cmd;
+    }
+
+    /**
+     * Options of the load command extracting only the tags of a projection. The template
+     * of the last projection is kept, as a caller usually loads many files with the same one.
+     */
+    const ExifToolCommandTemplate& loadCommand(const ExifToolProjection& projection)
+    {
+        if (projection.isAll())
+        {
+            return loadCommand();
+        }
+
+        const QString key = projection.toString();
+
+        if (key != projectionKey)
+        {
+            projectionKey = key;
+            projectionCmd.setOptions(loadCommand().options() + projection.arguments());
+        }
+
+        return projectionCmd;
+    }
+
+    /**
+     * Cancel a command still queued on the shared process or on the pool, so ExifTool
+     * does not parse files for a destroyed parser.
+     */
+    void cancelCommand(int cmdId)
+    {
+        if (!proc->cancel(cmdId) && pool)
+        {
+            pool->cancel(cmdId);
+        }
+    }
+
+    /**
+     * Return a key identifying the program run by the shared process: the executable found
+     * in the PATH for a bare name, with its size and date to detect an upgrade in place,
+     * and the Perl interpreter.
+     */
+    static QString programKey(const QString& program, const QString& perlPath)
+    {
+        QString resolved = program;
+
+        if (!program.contains(QLatin1Char('/')) && !program.contains(QLatin1Char('\\')))
+        {
+            resolved = QStandardPaths::findExecutable(program);
+        }
+
+        const QFileInfo info(resolved);
+
+        return info.canonicalFilePath()                                 + QLatin1Char(':') +
+               QString::number(info.size())                             + QLatin1Char(':') +
+               QString::number(info.lastModified().toMSecsSinceEpoch()) + QLatin1Char('\n') +
+               perlPath;
+    }
+
+    /**
+     * Return the version of the program of the shared process, or an empty array while it is
+     * unknown. The version is read once per program by a "-ver" command queued on the shared
+     * process, without blocking: the caches are cold until it is received.
+     */
+    QByteArray programVersion()
+    {
+        const QString key = programKey(proc->program(), proc->perlPath());
+
+        QMutexLocker lock(&s_versionMutex);
+
+        QHash<QString, QByteArray>::const_iterator it = s_versions.constFind(key);
+
+        if (it != s_versions.constEnd())
+        {
+            return it.value();          // Empty if the version cannot be read: not asked again.
+        }
+
+        if (versionCmdId || s_versionQueries.contains(key))
+        {
+            return QByteArray();
+        }
+
+        if (proc->state() == QProcess::NotRunning)
+        {
+            proc->start();
+        }
+
+        versionCmdId = proc->command(QByteArrayList() << QByteArray("-ver"),
+                                     ExifToolProcess::NoCommandFlags,
+                                     VERSION_TIMEOUT, ExifToolProcess::InteractivePriority);
+
+        if (versionCmdId == 0)
+        {
+            s_versions.insert(key, QByteArray());
+
+            return QByteArray();
+        }
+
+        versionKey = key;
+        s_versionQueries.insert(key);
+
+        return QByteArray();
+    }
+
+    /**
+     * Record the version read by the "-ver" command, or its failure with an empty version.
+     * If record is false, the command was abandoned: the version is read again on the next load.
+     */
+    void setProgramVersion(const QByteArray& version, bool record = true)
+    {
+        QMutexLocker lock(&s_versionMutex);
+
+        s_versionQueries.remove(versionKey);
+
+        if (record)
+        {
+            const bool valid = (!version.isEmpty() && (version[0] >= '0') && (version[0] <= '9'));
+
+            if (!valid)
+            {
+                qWarning() << "ExifToolParser: cannot read the ExifTool version, results are not cached";
+            }
+
+            s_versions.insert(versionKey, valid ? version : QByteArray());
+        }
+
+        versionCmdId = 0;
+        versionKey.clear();
+    }
+
+    /**
+     * Return the part of the cache keys describing how files are loaded: the ExifTool version,
+     * and the load options. Return an empty array while the version is unknown: nothing is cached.
+     */
+    QByteArray cacheContext(const ExifToolProjection& projection)
+    {
+        if (programIdentity.isEmpty())
+        {
+            const QByteArray ver = programVersion();
+            programIdentity      = ver.isEmpty() ? QByteArray() : QByteArray("exiftool ") + ver;
+        }
+
+        if (programIdentity.isEmpty())
+        {
+            return QByteArray();
+        }
+
+        return programIdentity                                  + '\n' +
+               loadCommand(projection).options().join(' ')      + '\n' +
+               (translate ? "translate" : "raw");
+    }
+
+    bool cachesEnabled() const
+    {
+        return (diskCache || ExifToolMemoryCache::instance()->isEnabled());
+    }
+
+    /**
+     * Look up the result of a file in the memory cache, then in the disk cache.
+     * fileKey is the state of the file, used to promote a result of the disk cache in memory.
+     */
+    bool lookupCache(const QString& path,
+                     const QByteArray& context,
+                     const QByteArray& fileKey,
+                     LoadResult& result)
+    {
+        if (context.isEmpty())
+        {
+            return false;
+        }
+
+        ExifToolMemoryCache* const memoryCache = ExifToolMemoryCache::instance();
+
+        if (memoryCache->isEnabled() && memoryCache->lookup(path, context, result))
+        {
+            return true;
+        }
+
+        if (diskCache && diskCache->lookup(path, context, result))
+        {
+            if (memoryCache->isEnabled())
+            {
+                memoryCache->insert(path, context, fileKey, result);
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * Store the result of a file in the caches. fileKey is the state of the file taken
+     * when the load was sent: a file changed since is not cached.
+     */
+    void insertCache(const QString& path,
+                     const QByteArray& context,
+                     const QByteArray& fileKey,
+                     const LoadResult& result)
+    {
+        if (!result.isValid() || context.isEmpty())
+        {
+            return;
+        }
+
+        ExifToolMemoryCache* const memoryCache = ExifToolMemoryCache::instance();
+
+        if (memoryCache->isEnabled())
+        {
+            memoryCache->insert(path, context, fileKey, result);
+        }
+
+        if (diskCache)
+        {
+            diskCache->insert(path, context, fileKey, result);
+        }
+    }
+
+    /**
+     * Dispatch the output of a batch chunk to the results of its files, with the errors
+     * reported by ExifTool for the files without metadata.
+     */
+    void completeChunk(const ExifToolParser* const parser,
+                       const BatchChunk& chunk,
+                       const QByteArray& stdOut,
+                       const QByteArray& stdErr)
+    {
+        QList<LoadResult> results;
+        QElapsedTimer parseTimer;
+        parseTimer.start();
+
+        parser->parseOutput(stdOut, chunk.batch->projection, results);
+
+        proc->metrics()->record(ExifToolMetrics::JsonParse, parseTimer.nsecsElapsed() / 1000);
+
+        // Match the results with the files. ExifTool reports source files with '/' separators on all platforms.
+
+        QStringList sources;
+        QList<bool> used;
+
+        for (const LoadResult& result : results)
+        {
+            sources << QString(result.path).replace(QLatin1Char('\\'), QLatin1Char('/'));
+            used    << false;
+        }
+
+        const QList<QByteArray> errLines = stdErr.split('\n');
+
+        for (int i = 0 ; i < chunk.paths.size() ; ++i)
+        {
+            const QString path = QString(chunk.paths[i]).replace(QLatin1Char('\\'), QLatin1Char('/'));
+            int index          = sources.indexOf(path);
+
+            while ((index != -1) && used[index])
+            {
+                index = sources.indexOf(path, index + 1);
+            }
+
+            // Fallback when the path was rewritten: results are in the order of the files.
+
+            if ((index == -1) && (results.size() == chunk.paths.size()) && !used[i])
+            {
+                index = i;
+            }
+
+            if (index != -1)
+            {
+                used[index] = true;
+
+                if (i < chunk.fileKeys.size())
+                {
+                    insertCache(chunk.paths[i], chunk.batch->cacheContext, chunk.fileKeys[i], results[index]);
+                }
+
+                reportBatch(*chunk.batch, chunk.first + i, results[index]);
+
+                continue;
+            }
+
+            LoadResult result;
+            result.path = chunk.paths[i];
+
+            for (const QByteArray& line : errLines)
+            {
+                if (line.contains(chunk.paths[i].toUtf8()) || line.contains(path.toUtf8()))
+                {
+                    if (!result.errorString.isEmpty())
+                    {
+                        result.errorString.append(QLatin1Char('\n'));
+                    }
+
+                    result.errorString.append(QString::fromUtf8(line).trimmed());
+                }
+            }
+
+            if (result.errorString.isEmpty())
+            {
+                result.errorString = QLatin1String("No metadata returned by ExifTool");
+            }
+
+            reportBatch(*chunk.batch, chunk.first + i, result);
+        }
+    }
+
+public:
+
+    bool                                      translate;
+    ExifToolProcess*                          proc;             ///< Shared by all parser instances.
+    int                                       timeout;          ///< Maximum ExifTool execution time of a load, in milliseconds.
+    QHash<int, QFutureInterface<LoadResult> > pending;          ///< Loads in progress by command id.
+    QHash<int, ExifToolProjection>            projections;      ///< Projection of the pending loads not reading all tags.
+    QHash<int, QFutureInterface<QByteArray> > binaryPending;    ///< Binary tag fetches in progress by command id.
+    QHash<int, BatchChunk>                    batchChunks;      ///< Chunks of batch loads in progress by command id.
+    QHash<int, Scan>                          scans;            ///< Directory scans in progress by command id.
+    int                                       batchSize;        ///< Maximum number of files per ExifTool command of a batch load.
+    ExifToolPool*                             pool;             ///< Processes parsing the chunks of large batches in parallel, or nullptr.
+    ExifToolDiskCache*                        diskCache;        ///< Persistent cache of the results, or nullptr.
+    QByteArray                                programIdentity;  ///< ExifTool version of the cache keys, empty if unknown.
+    int                                       versionCmdId;     ///< Pending "-ver" command sent by this parser, or 0.
+    QString                                   versionKey;       ///< Program key of the pending "-ver" command.
+    QHash<int, CacheMiss>                     cacheMisses;      ///< Pending loads to cache by command id.
+    QString                                   projectionKey;
+    ExifToolCommandTemplate                   projectionCmd;    ///< Load command of the last projection used.
+    QString                                   parsedPath;
+    ExifToolTagStore                          parsedMap;
+    ExifToolTagStore                          ignoredMap;
+    QString                                   errorString;
+
+public:
+
+    static const int                          DEFAULT_TIMEOUT    = 120000;
+    static const int                          DEFAULT_BATCH_SIZE = 32;
+    static const int                          MAX_BATCH_SIZE     = 1000;
+    static const int                          VERSION_TIMEOUT    = 10000;
+
+    static QMutex                             s_versionMutex;
+    static QHash<QString, QByteArray>         s_versions;       ///< ExifTool versions by program key, empty if unreadable.
+    static QSet<QString>                      s_versionQueries; ///< Program keys which version is being read.
 };
 
-ExifToolParser::ExifToolParser(QObject* const parent)
-    : QObject(parent),
-      d      (new Private)
-{
-/*
-    // Post creation of hash tables for tag translations
+QMutex                     ExifToolParser::Private::s_versionMutex;
+QHash<QString, QByteArray> ExifToolParser::Private::s_versions;
+QSet<QString>              ExifToolParser::Private::s_versionQueries;
+
+ExifToolParser::ExifToolParser(QObject* const parent)
+    : QObject(parent),
+      d      (new Private)
+{
+    // Use the ExifTool process shared by all parsers, already started if another parser used it recently.
+
+    d->proc = ExifToolProcess::acquireSharedInstance();
+
+    connect(d->proc, &ExifToolProcess::signalCmdCompleted,
+            this, &ExifToolParser::slotCmdCompleted);
+
+    connect(d->proc, &ExifToolProcess::signalCmdFailed,
+            this, &ExifToolParser::slotCmdFailed);
+
+    connect(d->proc, &ExifToolProcess::signalErrorOccurred,
+            this, &ExifToolParser::slotErrorOccurred);
+
+    connect(d->proc, &ExifToolProcess::signalFinished,
+            this, &ExifToolParser::slotFinished);
+/*
+    connect(MetaEngineSettings::instance(), SIGNAL(signalSettingsChanged()),
+            this, SLOT(slotMetaEngineSettingsChanged()));
+*/
+    slotMetaEngineSettingsChanged();
+}
+
+ExifToolParser::~ExifToolParser()
+{
+    disconnect(d->proc, nullptr, this, nullptr);
+
+    if (d->pool)
+    {
+        disconnect(d->pool, nullptr, this, nullptr);
+    }
+
+    if (d->versionCmdId)
+    {
+        d->proc->cancel(d->versionCmdId);
+        d->setProgramVersion(QByteArray(), false);
+    }
+
+    for (QHash<int, QFutureInterface<LoadResult> >::iterator it = d->pending.begin() ;
+         it != d->pending.end() ; ++it)
+    {
+        d->cancelCommand(it.key());
+        Private::fail(it.value(), QLatin1String("ExifTool parser destroyed"));
+    }
+
+    for (QHash<int, QFutureInterface<QByteArray> >::iterator it = d->binaryPending.begin() ;
+         it != d->binaryPending.end() ; ++it)
+    {
+        d->cancelCommand(it.key());
+        it.value().reportResult(QByteArray());
+        it.value().reportFinished();
+    }
+
+    for (QHash<int, Private::BatchChunk>::const_iterator it = d->batchChunks.constBegin() ;
+         it != d->batchChunks.constEnd() ; ++it)
+    {
+        d->cancelCommand(it.key());
+        Private::failChunk(it.value(), QLatin1String("ExifTool parser destroyed"));
+    }
+
+    // The process of a scan can be emitting the signal which destroys the parser: it is deleted later.
+
+    for (QHash<int, Private::Scan>::const_iterator it = d->scans.constBegin() ;
+         it != d->scans.constEnd() ; ++it)
+    {
+        it.value().proc->setParent(nullptr);
+        Private::releaseScan(this, it.value(), true);
+    }
+
+    ExifToolProcess::releaseSharedInstance();
+
+    if (d->pool)
+    {
+        ExifToolPool::releaseSharedInstance();
+    }
+
+    delete d->diskCache;
+    delete d;
+}
+
+void ExifToolParser::setTranslations(bool b)
+{
+    d->translate = b;
+}
+
+void ExifToolParser::setTimeout(int msecs)
+{
+    d->timeout = qMax(0, msecs);
+}
+
+void ExifToolParser::setBatchSize(int size)
+{
+    d->batchSize = qBound(1, size, (int)Private::MAX_BATCH_SIZE);
+}
+
+int ExifToolParser::batchSize() const
+{
+    return d->batchSize;
+}
+
+bool ExifToolParser::setCacheFile(const QString& filePath)
+{
+    delete d->diskCache;
+    d->diskCache = nullptr;
+    d->cacheMisses.clear();
+
+    if (filePath.isEmpty())
+    {
+        return true;
+    }
+
+    d->diskCache = new ExifToolDiskCache(filePath);
+
+    if (!d->diskCache->open())
+    {
+        delete d->diskCache;
+        d->diskCache = nullptr;
+
+        return false;
+    }
+
+    return true;
+}
+
+QString ExifToolParser::cacheFile() const
+{
+    return (d->diskCache ? d->diskCache->filePath() : QString());
+}
+
+bool ExifToolParser::compactCache()
+{
+    return (d->diskCache && d->diskCache->compact());
+}
+
+QString ExifToolParser::currentParsedPath() const
+{
+    return d->parsedPath;
+}
+
+ExifToolParser::TagsMap ExifToolParser::currentParsedTags() const
+{
+    return d->parsedMap.toTagsMap();
+}
+
+ExifToolParser::TagsMap ExifToolParser::currentIgnoredTags() const
+{
+    return d->ignoredMap.toTagsMap();
+}
+
+QString ExifToolParser::currentErrorString() const
+{
+    return d->errorString;
+}
+
+ExifToolMetrics* ExifToolParser::metrics() const
+{
+    return d->proc->metrics();
+}
+
+bool ExifToolParser::load(const QString& path,
+                          ExifToolProcess::CommandPriority priority,
+                          const ExifToolProjection& projection)
+{
+    d->parsedPath.clear();
+    d->parsedMap.clear();
+    d->ignoredMap.clear();
+    d->errorString.clear();
+
+    QFuture<LoadResult> future = loadAsync(path, priority, projection);
+
+    if (!future.isFinished())
+    {
+        QEventLoop loop;
+        QFutureWatcher<LoadResult> watcher;
+
+        connect(&watcher, &QFutureWatcher<LoadResult>::finished,
+                &loop, &QEventLoop::quit);
+
+        watcher.setFuture(future);
+        loop.exec();
+    }
+
+    const LoadResult result = future.result();
+
+    if (!result.isValid())
+    {
+        d->errorString = result.errorString;
+
+        return false;
+    }
+
+    d->parsedPath = result.path;
+    d->parsedMap  = result.parsedTags;
+    d->ignoredMap = result.ignoredTags;
+
+    return true;
+}
+
+QFuture<ExifToolParser::LoadResult> ExifToolParser::loadAsync(const QString& path,
+                                                               ExifToolProcess::CommandPriority priority,
+                                                               const ExifToolProjection& projection)
+{
+    QFutureInterface<LoadResult> promise;
+    promise.reportStarted();
+    QFuture<LoadResult> future = promise.future();
+
+    QFileInfo fileInfo(path);
+
+    if (!fileInfo.exists())
+    {
+        Private::fail(promise, QString::fromLatin1("File %1 does not exist").arg(path));
+
+        return future;
+    }
+
+    Private::CacheMiss cacheMiss;
+
+    if (d->cachesEnabled())
+    {
+        cacheMiss.path    = fileInfo.filePath();
+        cacheMiss.context = d->cacheContext(projection);
+        cacheMiss.fileKey = ExifToolDiskCache::fileKey(cacheMiss.path);
+        LoadResult result;
+
+        if (d->lookupCache(cacheMiss.path, cacheMiss.context, cacheMiss.fileKey, result))
+        {
+            promise.reportResult(result);
+            promise.reportFinished();
+
+            return future;
+        }
+    }
+
+    // Read metadata from the file. Start ExifToolProcess if it is not yet running
+
+    if (d->proc->state() == QProcess::NotRunning)
+    {
+        d->proc->start();
+    }
+
+    // Send command to ExifToolProcess. Loads waiting in the queue with the same projection
+    // are merged in one execution.
+
+    const int cmdId = d->proc->command(d->loadCommand(projection),
+                                       QDir::toNativeSeparators(fileInfo.filePath()).toUtf8(),
+                                       ExifToolProcess::CoalesceFiles,
+                                       d->timeout, priority);                   // See additional notes
+
+    if (cmdId == 0)
+    {
+        qWarning() << "ExifTool parsing command cannot be sent (" << d->proc->program() << ")";
+        Private::fail(promise, QLatin1String("ExifTool parsing command cannot be sent"));
+
+        return future;
+    }
+
+    d->pending.insert(cmdId, promise);
+
+    if (!projection.isAll())
+    {
+        d->projections.insert(cmdId, projection);
+    }
+
+    if (d->cachesEnabled())
+    {
+        d->cacheMisses.insert(cmdId, cacheMiss);
+    }
+
+    return future;
+}
+
+QList<ExifToolParser::LoadResult> ExifToolParser::loadBatch(const QStringList& paths,
+                                                           ExifToolProcess::CommandPriority priority,
+                                                           const ExifToolProjection& projection)
+{
+    QFuture<LoadResult> future = loadBatchAsync(paths, priority, projection);
+
+    if (!future.isFinished())
+    {
+        QEventLoop loop;
+        QFutureWatcher<LoadResult> watcher;
+
+        connect(&watcher, &QFutureWatcher<LoadResult>::finished,
+                &loop, &QEventLoop::quit);
+
+        watcher.setFuture(future);
+        loop.exec();
+    }
+
+    return future.results();
+}
+
+QFuture<ExifToolParser::LoadResult> ExifToolParser::loadBatchAsync(const QStringList& paths,
+                                                                    ExifToolProcess::CommandPriority priority,
+                                                                    const ExifToolProjection& projection)
+{
+    QSharedPointer<Private::Batch> batch(new Private::Batch);
+    batch->projection          = projection;
+    batch->cacheContext        = d->cachesEnabled() ? d->cacheContext(projection) : QByteArray();
+    batch->remaining           = paths.size();
+    batch->promise.reportStarted();
+    batch->promise.setProgressRange(0, paths.size());
+    QFuture<LoadResult> future = batch->promise.future();
+
+    if (paths.isEmpty())
+    {
+        batch->promise.reportFinished();
+
+        return future;
+    }
+
+    const ExifToolCommandTemplate cmdTemplate = d->loadCommand(projection);
+    int index                                 = 0;
+
+    // The chunks of a large batch are parsed in parallel by a pool of ExifTool processes, one per core,
+    // shared by all parsers. The pool has no priorities: a large batch is a bulk import, not an interactive load.
+
+    if ((paths.size() > d->batchSize) && !d->pool)
+    {
+        d->pool = ExifToolPool::acquireSharedInstance();
+
+        connect(d->pool, &ExifToolPool::signalCmdCompleted,
+                this, &ExifToolParser::slotCmdCompleted);
+
+        connect(d->pool, &ExifToolPool::signalCmdFailed,
+                this, &ExifToolParser::slotCmdFailed);
+    }
+
+    if ((paths.size() > d->batchSize) && d->pool)
+    {
+        d->pool->setProgram(d->proc->program(), d->proc->perlPath());
+        d->pool->start();
+    }
+
+    ExifToolPool* const pool = (paths.size() > d->batchSize) ? d->pool : nullptr;
+
+    while (index < paths.size())
+    {
+        // Fill a chunk with the next existing files. Missing files are reported at once.
+
+        Private::BatchChunk chunk;
+        chunk.batch = batch;
+        QByteArrayList files;
+
+        while ((index < paths.size()) && (files.size() < d->batchSize))
+        {
+            QFileInfo fileInfo(paths[index]);
+
+            if (!fileInfo.exists())
+            {
+                // Keep the files of a chunk contiguous in the list: a missing file ends the chunk.
+
+                if (!files.isEmpty())
+                {
+                    break;
+                }
+
+                LoadResult result;
+                result.errorString = QString::fromLatin1("File %1 does not exist").arg(paths[index]);
+                Private::reportBatch(*batch, index, result);
+                ++index;
+
+                continue;
+            }
+
+            // A file found in the cache also ends the chunk, as a missing file.
+
+            const QByteArray fileKey = d->cachesEnabled() ? ExifToolDiskCache::fileKey(fileInfo.filePath())
+                                                          : QByteArray();
+            LoadResult cached;
+
+            if (d->cachesEnabled() && d->lookupCache(fileInfo.filePath(), batch->cacheContext, fileKey, cached))
+            {
+                if (!files.isEmpty())
+                {
+                    break;
+                }
+
+                Private::reportBatch(*batch, index, cached);
+                ++index;
+
+                continue;
+            }
+
+            if (files.isEmpty())
+            {
+                chunk.first = index;
+            }
+
+            const QString nativePath = QDir::toNativeSeparators(fileInfo.filePath());
+            chunk.paths << nativePath;
+            files       << nativePath.toUtf8();
+
+            chunk.fileKeys << fileKey;
+            ++index;
+        }
+
+        if (files.isEmpty())
+        {
+            continue;
+        }
+
+        // The timeout applies to each file of the chunk.
+
+        int cmdId = 0;
+
+        if (pool)
+        {
+            cmdId = pool->command(cmdTemplate.options() + files, d->timeout * files.size());
+        }
+
+        // Without a process left in the pool, the chunk is parsed by the shared process.
+
+        if (cmdId == 0)
+        {
+            if (d->proc->state() == QProcess::NotRunning)
+            {
+                d->proc->start();
+            }
 
-    ExifToolTranslator::instance();
-*/
-    // Create ExifTool parser instance.
+            cmdId = d->proc->command(cmdTemplate, files, ExifToolProcess::NoCommandFlags,
+                                     d->timeout * files.size(), priority);
+        }
 
-    d->proc = new ExifToolProcess(parent);
-/*
-    connect(MetaEngineSettings::instance(), SIGNAL(signalSettingsChanged()),
-            this, SLOT(slotMetaEngineSettingsChanged()));
-*/
-    slotMetaEngineSettingsChanged();
+        if (cmdId == 0)
+        {
+            qWarning() << "ExifTool batch parsing command cannot be sent (" << d->proc->program() << ")";
+            Private::failChunk(chunk, QLatin1String("ExifTool parsing command cannot be sent"));
+
+            continue;
+        }
+
+        d->batchChunks.insert(cmdId, chunk);
+    }
+
+    return future;
 }
 
-ExifToolParser::~ExifToolParser()
+int ExifToolParser::scanDirectory(const QString& dirPath,
+                                  const QStringList& extensions,
+                                  const ExifToolProjection& projection)
 {
-    if (d->loop)
+    QFileInfo dirInfo(dirPath);
+
+    if (!dirInfo.isDir())
     {
-        d->loop->quit();
-        delete d->loop;
+        qWarning() << "ExifToolParser: cannot scan" << dirPath << ", this is not a directory";
+
+        return 0;
     }
 
-    d->proc->terminate();
+    // A scan can run for minutes: it uses its own process, not to block the loads queued on the shared one.
 
-    delete d->proc;
-    delete d;
-}
+    Private::Scan scan;
+    scan.projection = projection;
+    scan.proc       = new ExifToolProcess(this);
+    scan.proc->setProgram(d->proc->program(), d->proc->perlPath());
+    scan.proc->setCommonArgs(d->proc->commonArgs());
 
-void ExifToolParser::setTranslations(bool b)
-{
-    d->translate = b;
-}
+    connect(scan.proc, &ExifToolProcess::signalCmdData,
+            this, &ExifToolParser::slotCmdData);
 
-QString ExifToolParser::currentParsedPath() const
-{
-    return d->parsedPath;
+    connect(scan.proc, &ExifToolProcess::signalCmdCompleted,
+            this, &ExifToolParser::slotCmdCompleted);
+
+    connect(scan.proc, &ExifToolProcess::signalCmdFailed,
+            this, &ExifToolParser::slotCmdFailed);
+
+    scan.proc->start();
+
+    // ExifTool walks the tree and prints the JSON object of each file as soon as it is read.
+    // The output is streamed to slotCmdData(), without timeout as the tree size is unknown.
+
+    QByteArrayList cmdArgs = d->loadCommand(projection).options();
+    cmdArgs << QByteArray("-r");
+
+    for (const QString& ext : extensions)
+    {
+        cmdArgs << QByteArray("-ext") << ext.toUtf8();
+    }
+
+    cmdArgs << QDir::toNativeSeparators(dirInfo.filePath()).toUtf8();
+
+    const int cmdId = scan.proc->command(cmdArgs, ExifToolProcess::StreamOutput);
+
+    if (cmdId == 0)
+    {
+        qWarning() << "ExifTool scan command cannot be sent (" << scan.proc->program() << ")";
+        Private::releaseScan(this, scan, true);
+
+        return 0;
+    }
+
+    d->scans.insert(cmdId, scan);
+
+    return cmdId;
 }
 
-ExifToolParser::TagsMap ExifToolParser::currentParsedTags() const
+bool ExifToolParser::cancelScan(int scanId)
 {
-    return d->parsedMap;
+    if (!d->scans.contains(scanId))
+    {
+        return false;
+    }
+
+    const Private::Scan scan = d->scans.take(scanId);
+    Private::releaseScan(this, scan, true);
+
+    emit signalScanFinished(scanId, scan.files, QLatin1String("ExifTool scan cancelled"));
+
+    return true;
 }
 
-ExifToolParser::TagsMap ExifToolParser::currentIgnoredTags() const
+void ExifToolParser::slotCmdData(int cmdId, const QByteArray& cmdOutputChunk)
 {
-    return d->ignoredMap;
+    QHash<int, Private::Scan>::iterator it = d->scans.find(cmdId);
+
+    if (it == d->scans.end())
+    {
+        return;
+    }
+
+    const QList<QByteArray> objects = it.value().splitter.feed(cmdOutputChunk);
+
+    for (const QByteArray& object : objects)
+    {
+        QList<LoadResult> results;
+        QElapsedTimer parseTimer;
+        parseTimer.start();
+
+        parseOutput(QByteArray("[") + object + QByteArray("]"), it.value().projection, results);
+
+        d->proc->metrics()->record(ExifToolMetrics::JsonParse, parseTimer.nsecsElapsed() / 1000);
+
+        for (LoadResult& result : results)
+        {
+            if (result.path.isEmpty())
+            {
+                result.errorString = QLatin1String("No source file returned by ExifTool");
+            }
+
+            const int files = ++it.value().files;
+
+            // A receiver can cancel the scan or destroy the parser.
+
+            QPointer<ExifToolParser> self(this);
+
+            emit signalScanResult(cmdId, result);
+
+            if (!self)
+            {
+                return;
+            }
+
+            emit signalScanProgress(cmdId, files);
+
+            if (!self)
+            {
+                return;
+            }
+
+            it = d->scans.find(cmdId);
+
+            if (it == d->scans.end())
+            {
+                return;
+            }
+        }
+    }
 }
 
-QString ExifToolParser::currentErrorString() const
+QByteArray ExifToolParser::fetchBinaryTag(const QString& path,
+                                          const QString& tag,
+                                          ExifToolProcess::CommandPriority priority)
 {
-    return d->proc->errorString();
+    QFuture<QByteArray> future = fetchBinaryTagAsync(path, tag, priority);
+
+    if (!future.isFinished())
+    {
+        QEventLoop loop;
+        QFutureWatcher<QByteArray> watcher;
+
+        connect(&watcher, &QFutureWatcher<QByteArray>::finished,
+                &loop, &QEventLoop::quit);
+
+        watcher.setFuture(future);
+        loop.exec();
+    }
+
+    return future.result();
 }
 
-bool ExifToolParser::load(const QString& path)
+QFuture<QByteArray> ExifToolParser::fetchBinaryTagAsync(const QString& path,
+                                                        const QString& tag,
+                                                        ExifToolProcess::CommandPriority priority)
 {
-    d->parsedPath.clear();
-    d->parsedMap.clear();
-    d->ignoredMap.clear();
+    QFutureInterface<QByteArray> promise;
+    promise.reportStarted();
+    QFuture<QByteArray> future = promise.future();
 
     QFileInfo fileInfo(path);
 
-    if (!fileInfo.exists())
+    if (!fileInfo.exists() || tag.isEmpty())
     {
-        return false;
-    }
+        qWarning() << "ExifToolParser: cannot fetch tag" << tag << "from" << path;
+        promise.reportResult(QByteArray());
+        promise.reportFinished();
 
-    // Read metadata from the file. Start ExifToolProcess
-
-    d->proc->start();
+        return future;
+    }
 
-    if (!d->proc->waitForStarted(500))
+    if (d->proc->state() == QProcess::NotRunning)
     {
-        d->proc->kill();
-        qWarning() << "ExifTool process cannot be started (" << d->proc->program() << ")";
-
-        return false;
+        d->proc->start();
     }
 
-    // Build command (get metadata as JSON array)
+    // The parsed tag names use dots between the groups, ExifTool uses colons.
+    // The data is returned in JSON as base64, so the binary bytes do not interfere with the
+    // command sentinels and are not altered by line ending conversions.
+
+    QString tagName = tag;
+    tagName.replace(QLatin1Char('.'), QLatin1Char(':'));
 
     QByteArrayList cmdArgs;
     cmdArgs << QByteArray("-json");
-    cmdArgs << QByteArray("-binary");
-    cmdArgs << QByteArray("-G:0:1:2:4:6");
-    cmdArgs << QByteArray("-n");
-    cmdArgs << QByteArray("-l");
+    cmdArgs << QByteArray("-b");
+    cmdArgs << QByteArray("-") + tagName.toUtf8();
     cmdArgs << QDir::toNativeSeparators(fileInfo.filePath()).toUtf8();
 
-    // Send command to ExifToolProcess
+    const int cmdId = d->proc->command(cmdArgs, ExifToolProcess::NoCommandFlags, d->timeout, priority);
+
+    if (cmdId == 0)
+    {
+        qWarning() << "ExifTool binary tag command cannot be sent (" << d->proc->program() << ")";
+        promise.reportResult(QByteArray());
+        promise.reportFinished();
+
+        return future;
+    }
+
+    d->binaryPending.insert(cmdId, promise);
 
-    int ret = d->proc->command(cmdArgs); // See additional notes
+    return future;
+}
 
-    if (ret == 0)
+void ExifToolParser::slotCmdCompleted(int cmdId,
+                                      int /*execTime*/,
+                                      const QByteArray& stdOut,
+                                      const QByteArray& stdErr)
+{
+    if (d->versionCmdId && (cmdId == d->versionCmdId))
     {
-        qWarning() << "ExifTool parsing command cannot be sent";
+        d->setProgramVersion(stdOut.trimmed());
 
-        return false;
+        return;
     }
 
-    d->loop = new QEventLoop(this);
+    QHash<int, QFutureInterface<QByteArray> >::iterator bit = d->binaryPending.find(cmdId);
+
+    if (bit != d->binaryPending.end())
+    {
+        QFutureInterface<QByteArray> promise = bit.value();
+        d->binaryPending.erase(bit);
 
-    // Connect at cmdCompleted signal to slot
+        const QByteArray data = parseBinaryOutput(stdOut);
 
-    QList<QMetaObject::Connection> hdls;
+        if (data.isNull() && !stdErr.isEmpty())
+        {
+            qWarning() << "ExifToolParser: cannot fetch binary tag:" << QString::fromUtf8(stdErr).trimmed();
+        }
 
-    hdls << connect(d->proc, &ExifToolProcess::signalCmdCompleted,
-                    this, &ExifToolParser::slotCmdCompleted);
+        promise.reportResult(data);
+        promise.reportFinished();
 
-    hdls << connect(d->proc, &ExifToolProcess::signalErrorOccurred,
-                    this, &ExifToolParser::slotErrorOccurred);
+        return;
+    }
 
-    hdls << connect(d->proc, &ExifToolProcess::signalFinished,
-                    this, &ExifToolParser::slotFinished);
+    // The process is shared: ignore commands sent by other parsers.
 
-    d->loop->exec();
+    QHash<int, Private::BatchChunk>::iterator cit = d->batchChunks.find(cmdId);
 
-    foreach (QMetaObject::Connection hdl, hdls)
+    if (cit != d->batchChunks.end())
     {
-        disconnect(hdl);
+        const Private::BatchChunk chunk = cit.value();
+        d->batchChunks.erase(cit);
+
+        d->completeChunk(this, chunk, stdOut, stdErr);
+
+        return;
     }
 
-    return true;
+    if (d->scans.contains(cmdId))
+    {
+        // All the output was already delivered by slotCmdData().
+
+        const Private::Scan scan = d->scans.take(cmdId);
+        Private::releaseScan(this, scan, false);
+
+        emit signalScanFinished(cmdId, scan.files, QString());
+
+        return;
+    }
+
+    QHash<int, QFutureInterface<LoadResult> >::iterator it = d->pending.find(cmdId);
+
+    if (it == d->pending.end())
+    {
+        return;
+    }
+
+    QFutureInterface<LoadResult> promise = it.value();
+    d->pending.erase(it);
+
+    const ExifToolProjection projection = d->projections.take(cmdId);
+    QList<LoadResult> results;
+    QElapsedTimer parseTimer;
+    parseTimer.start();
+
+    parseOutput(stdOut, projection, results);
+
+    d->proc->metrics()->record(ExifToolMetrics::JsonParse, parseTimer.nsecsElapsed() / 1000);
+
+    // A load reads one file.
+
+    LoadResult result = results.value(0);
+
+    if (result.path.isEmpty())
+    {
+        result.errorString = stdErr.isEmpty() ? QLatin1String("No metadata returned by ExifTool")
+                                              : QString::fromUtf8(stdErr).trimmed();
+    }
+
+    const Private::CacheMiss cacheMiss = d->cacheMisses.take(cmdId);
+
+    if (!cacheMiss.path.isEmpty())
+    {
+        d->insertCache(cacheMiss.path, cacheMiss.context, cacheMiss.fileKey, result);
+    }
+
+    promise.reportResult(result);
+    promise.reportFinished();
 }
 
-void ExifToolParser::slotCmdCompleted(int /*cmdId*/,
-                                      int /*execTime*/,
-                                      const QByteArray& stdOut,
-                                      const QByteArray& /*stdErr*/)
+QByteArray ExifToolParser::parseBinaryOutput(const QByteArray& stdOut) const
 {
-    // Convert JSON array as QVariantMap
+    Private::BinaryHandler handler;
+    ExifToolJsonDecoder decoder(&handler);
 
-    QJsonDocument jsonDoc     = QJsonDocument::fromJson(stdOut);
-    QJsonArray    jsonArray   = jsonDoc.array();
-    QJsonObject   jsonObject  = jsonArray.at(0).toObject();
-    QVariantMap   metadataMap = jsonObject.toVariantMap();
+    if (!decoder.decode(stdOut) || !handler.found)
+    {
+        return QByteArray();
+    }
 
-    for (QVariantMap::const_iterator it = metadataMap.constBegin() ;
-        it != metadataMap.constEnd() ; ++it)
+    // With -b, ExifTool encodes binary values in base64. Other values are returned as text.
+
+    if (handler.data.startsWith(QLatin1String("base64:")))
     {
-        QString     tagNameExifTool;
-        QString     tagType;
-        QStringList sections  = it.key().split(QLatin1Char(':'));
+        return QByteArray::fromBase64(handler.data.mid(7).toLatin1());
+    }
 
-        if      (sections.size() == 5)
-        {
-            tagNameExifTool = QString::fromLatin1("%1.%2.%3.%4")
-                                  .arg(sections[0])
-                                  .arg(sections[1])
-                                  .arg(sections[2])
-                                  .arg(sections[4]);
-            tagType         = sections[3];
-        }
-        else if (sections.size() == 4)
-        {
-            tagNameExifTool = QString::fromLatin1("%1.%2.%3.%4")
-                                  .arg(sections[0])
-                                  .arg(sections[1])
-                                  .arg(sections[2])
-                                  .arg(sections[3]);
-        }
-        else if (sections[0] == QLatin1String("SourceFile"))
-        {
-            d->parsedPath = it.value().toString();
-            continue;
-        }
-        else
-        {
-            continue;
-        }
+    return handler.data.toUtf8();
+}
 
-        QVariantMap propsMap = it.value().toMap();
-        QString data         = propsMap.find(QLatin1String("val")).value().toString();
-        QString desc         = propsMap.find(QLatin1String("desc")).value().toString();
+void ExifToolParser::parseOutput(const QByteArray& stdOut,
+                                 const ExifToolProjection& projection,
+                                 QList<LoadResult>& results) const
+{
+    // Decode the JSON array in one pass, without intermediate document.
+    // Tags are handled by parseTag() as soon as they are read.
 
-        if (d->translate)
-        {
-/*
-            // Translate ExifTool tag names to Exiv2 scheme
+    Private::LoadHandler handler(this, projection, results);
+    ExifToolJsonDecoder decoder(&handler);
 
-            if (ExifToolTranslator::instance()->isIgnoredGroup(tagNameExifTool))
-            {
-                if (!tagNameExifTool.startsWith(QLatin1String("...")))
-                {
-                    d->ignoredMap.insert(tagNameExifTool, QVariantList() << QString() << data << tagType);
-                }
+    if (!decoder.decode(stdOut))
+    {
+        qWarning() << "ExifToolParser: invalid JSON output from ExifTool:" << decoder.errorString();
+    }
+}
 
-                continue;
-            }
+void ExifToolParser::parseTag(const char* const key,
+                              int keySize,
+                              const QString& value,
+                              const QString& desc,
+                              const ExifToolProjection& projection,
+                              LoadResult& result) const
+{
+    // The key is "Family0:Family1:Family2[:Type]:Tag" with -G:0:1:2:4:6. It is decoded once
+    // per process by the dictionary, which shares the tag name and type with all files.
 
-            // Tags to translate To Exiv2 naming scheme.
+    const ExifToolTagDictionary::Entry* const entry = ExifToolTagDictionary::instance()->intern(key, keySize, desc);
 
-            QString tagNameExiv2 = ExifToolTranslator::instance()->translateToExiv2(tagNameExifTool);
-            QVariant var;
+    // ExifTool also reports tags which are not requested, as SourceFile or tags of the same name in other groups.
 
-            if      (tagNameExiv2.startsWith(QLatin1String("Exif.")))
+    if (!entry || !projection.accepts(entry))
+    {
+        return;
+    }
+
+    const QString& tagNameExifTool = entry->name;
+    const QString& tagType         = entry->type;
+    QString data                   = value;
+
+    if (d->translate)
+    {
+        // Translate ExifTool tag names to Exiv2 scheme. The translation of an entry is computed
+        // once per process, further lookups do not allocate.
+
+        const ExifToolTranslator::Translation translation = ExifToolTranslator::instance()->translate(entry);
+        const QString& tagNameExiv2                       = translation.exiv2Name;
+
+        if (translation.ignoredGroup || tagNameExiv2.isEmpty())
+        {
+            result.ignoredTags.insert(tagNameExifTool, tagNameExiv2, data, tagType, desc);
+
+            return;
+        }
+
+        QVariant var;
+
+        if (tagNameExiv2.startsWith(QLatin1String("Exif.")))
+        {
+            switch (translation.typeCode)
             {
-                if      (tagType == QLatin1String("string"))
+                case ExifToolTranslator::StringType:
                 {
                     var = data;
+                    break;
                 }
-                else if (
-                         (tagType == QLatin1String("int8u"))  ||
-                         (tagType == QLatin1String("int16u")) ||
-                         (tagType == QLatin1String("int32u")) ||
-                         (tagType == QLatin1String("int8s"))  ||
-                         (tagType == QLatin1String("int16s")) ||
-                         (tagType == QLatin1String("int32s"))
-                        )
+
+                case ExifToolTranslator::IntegerType:
                 {
                     var = data.toLongLong();
+                    break;
                 }
-                else if (tagType == QLatin1String("undef"))
+
+                case ExifToolTranslator::UndefinedType:
                 {
                     if (
                         (tagNameExiv2 == QLatin1String("Exif.Photo.ComponentsConfiguration")) ||
@@ -298,79 +1492,140 @@ void ExifToolParser::slotCmdCompleted(int /*cmdId*/,
                     {
                         var = data.toLatin1();
                     }
+
+                    break;
                 }
-                else if (
-                         (tagType == QLatin1String("double"))      ||
-                         (tagType == QLatin1String("float"))       ||
-                         (tagType == QLatin1String("rational64s")) ||
-                         (tagType == QLatin1String("rational64u"))
-                        )
+
+                case ExifToolTranslator::RealType:
                 {
                     var = data.toDouble();
+                    break;
                 }
-                else
+
+                default:
                 {
-                    d->ignoredMap.insert(tagNameExiv2, QVariantList() << tagNameExifTool << data << tagType);
+                    result.ignoredTags.insert(tagNameExifTool, tagNameExiv2, data, tagType, desc);
+
+                    return;
                 }
             }
-            else if (tagNameExiv2.startsWith(QLatin1String("Iptc.")))
-            {
-                var = data;
-            }
-            else if (tagNameExiv2.startsWith(QLatin1String("Xmp.")))
-            {
-                var = data;
-            }
-
-            d->parsedMap.insert(tagNameExiv2, QVariantList()
-                                                 << tagNameExifTool // ExifTool tag name.
-                                                 << var             // ExifTool data as variant.
-                                                 << tagType         // ExifTool data type.
-                                                 << desc);          // ExifTool tag description.
-*/
         }
         else
         {
-            // Do not translate ExifTool tag names to Exiv2 scheme.
-
-            if (data.startsWith(QLatin1String("base64:")))
-            {
-                data = QLatin1String("binary data...");
-            }
+            // Iptc and Xmp values are strings.
 
-            d->parsedMap.insert(tagNameExifTool, QVariantList()
-                                                     << QString()   // Empty Exiv2 tag name.
-                                                     << data        // ExifTool Raw data as string.
-                                                     << tagType     // ExifTool data type.
-                                                     << desc);      // ExifTool tag description.
+            var = data;
         }
-    }
 
-    if (d->loop)
+        result.parsedTags.insert(tagNameExiv2,
+                                 tagNameExifTool,       // ExifTool tag name.
+                                 var,                   // ExifTool data as variant.
+                                 tagType,               // ExifTool data type.
+                                 desc);                 // ExifTool tag description.
+    }
+    else
     {
-        d->loop->quit();
+        // Do not translate ExifTool tag names to Exiv2 scheme.
+        // Binary data is an ExifTool placeholder with its size, see fetchBinaryTag().
+
+        result.parsedTags.insert(entry,                 // ExifTool tag name and data type, empty Exiv2 tag name.
+                                 data,                  // ExifTool Raw data as string.
+                                 desc);                 // ExifTool tag description.
     }
 }
 
-void ExifToolParser::slotErrorOccurred(QProcess::ProcessError error)
+void ExifToolParser::slotCmdFailed(int cmdId, ExifToolProcess::CommandError error)
 {
-    qWarning() << "ExifTool process exited with error:" << error;
+    if (d->versionCmdId && (cmdId == d->versionCmdId))
+    {
+        d->setProgramVersion(QByteArray(), (error == ExifToolProcess::CommandTimedOut) ||
+                                           (error == ExifToolProcess::CommandCrashed));
+
+        return;
+    }
+
+    if (d->scans.contains(cmdId))
+    {
+        const Private::Scan scan = d->scans.take(cmdId);
+        Private::releaseScan(this, scan, true);
+
+        emit signalScanFinished(cmdId, scan.files, (error == ExifToolProcess::CommandCancelled) ? QLatin1String("ExifTool scan cancelled")
+                                                                                                : QLatin1String("ExifTool scan failed"));
+
+        return;
+    }
+
+    QHash<int, Private::BatchChunk>::iterator cit = d->batchChunks.find(cmdId);
+
+    if (cit != d->batchChunks.end())
+    {
+        const Private::BatchChunk chunk = cit.value();
+        d->batchChunks.erase(cit);
+
+        Private::failChunk(chunk, (error == ExifToolProcess::CommandTimedOut) ? QLatin1String("ExifTool parsing timed out")
+                                                                              : QLatin1String("ExifTool parsing command was dropped"));
+
+        return;
+    }
+
+    QHash<int, QFutureInterface<QByteArray> >::iterator bit = d->binaryPending.find(cmdId);
 
-    if (d->loop)
+    if (bit != d->binaryPending.end())
     {
-        d->loop->quit();
+        qWarning() << "ExifToolParser: binary tag command failed with error" << error;
+        bit.value().reportResult(QByteArray());
+        bit.value().reportFinished();
+        d->binaryPending.erase(bit);
+
+        return;
+    }
+
+    QHash<int, QFutureInterface<LoadResult> >::iterator it = d->pending.find(cmdId);
+
+    if (it == d->pending.end())
+    {
+        return;
+    }
+
+    QFutureInterface<LoadResult> promise = it.value();
+    d->pending.erase(it);
+    d->projections.remove(cmdId);
+    d->cacheMisses.remove(cmdId);
+
+    switch (error)
+    {
+        case ExifToolProcess::CommandTimedOut:
+        {
+            Private::fail(promise, QLatin1String("ExifTool parsing timed out"));
+            break;
+        }
+
+        case ExifToolProcess::CommandCancelled:
+        {
+            Private::fail(promise, QLatin1String("ExifTool parsing cancelled"));
+            break;
+        }
+
+        default:
+        {
+            Private::fail(promise, d->proc->errorString().isEmpty() ? QLatin1String("ExifTool parsing command was dropped")
+                                                                    : d->proc->errorString());
+            break;
+        }
     }
 }
 
+void ExifToolParser::slotErrorOccurred(QProcess::ProcessError error)
+{
+    // Pending loads are notified by slotCmdFailed().
+
+    qWarning() << "ExifTool process exited with error:" << error;
+}
+
 void ExifToolParser::slotFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     qDebug() << "ExifTool process finished with code:" << exitCode
                                     << "and status" << exitStatus;
-
-    if (d->loop)
-    {
-        d->loop->quit();
-    }
 }
 
 void ExifToolParser::slotMetaEngineSettingsChanged()
@@ -390,6 +1645,17 @@ void ExifToolParser::slotMetaEngineSettingsChanged()
 #endif
 
     );
+
+    // The cache keys are computed again with the version of the new program.
+
+    d->programIdentity.clear();
+
+    // The shared pool runs the new program too, its busy workers are restarted.
+
+    if (d->pool)
+    {
+        d->pool->setProgram(d->proc->program(), d->proc->perlPath());
+    }
 }
 
 QStringList ExifToolParser::defaultExifToolSearchPaths() const
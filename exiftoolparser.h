@@ -33,12 +33,17 @@
 #include <QByteArray>
 #include <QProcess>
 #include <QStringList>
+#include <QFuture>
+
+// Local includes
+
+#include "exiftoolprocess.h"
+#include "exiftooltagstore.h"
+#include "exiftoolprojection.h"
 
 namespace Digikam
 {
 
-class ExifToolProcess;
-
 class ExifToolParser : public QObject
 {
     Q_OBJECT
@@ -59,15 +64,138 @@ public:
      *  -   ExifTool Tag value          (QString).
      *  -   ExifTool Tag type           (QString).
      *  -   ExifTool Tag description    (QString).
+     *
+     * LoadResult stores the same tags in the more compact ExifToolTagStore.
      */
-    typedef QHash<QString, QVariantList> TagsMap;
+    typedef ExifToolTagStore::TagsMap TagsMap;
+
+    /**
+     * The metadata parsed from one file.
+     */
+    class LoadResult
+    {
+    public:
+
+        LoadResult()
+        {
+        }
+
+        bool isValid() const
+        {
+            return errorString.isEmpty();
+        }
+
+        QString          path;          ///< Source file as reported by ExifTool.
+        ExifToolTagStore parsedTags;    ///< See TagsMap for the tag properties, toTagsMap() converts it.
+        ExifToolTagStore ignoredTags;
+        QString          errorString;   ///< Empty if the file was parsed.
+    };
 
 public:
 
     explicit ExifToolParser(QObject* const parent = nullptr);
     ~ExifToolParser();
 
-    bool load(const QString& path);
+    /**
+     * Load metadata from a file, and block until parsing is done by processing events.
+     * Results are available with currentParsedPath(), currentParsedTags() and currentIgnoredTags().
+     * This is a wrapper over loadAsync().
+     */
+    bool load(const QString& path,
+              ExifToolProcess::CommandPriority priority = ExifToolProcess::NormalPriority,
+              const ExifToolProjection& projection      = ExifToolProjection());
+
+    /**
+     * Start to load metadata from a file and return immediately. The returned future is
+     * finished when the file is parsed, which requires the event loop of the parser thread to run.
+     * Any number of loads can be in progress at the same time.
+     * With a projection, only the selected tags are extracted by ExifTool and parsed.
+     */
+    QFuture<LoadResult> loadAsync(const QString& path,
+                                  ExifToolProcess::CommandPriority priority = ExifToolProcess::NormalPriority,
+                                  const ExifToolProjection& projection      = ExifToolProjection());
+
+    /**
+     * Load metadata from a list of files, and block until parsing is done by processing events.
+     * Return one result per file, in the order of the list. A file which cannot be parsed
+     * has an error in its result, without affecting the other ones.
+     * This is a wrapper over loadBatchAsync(), the current parsed tags are not changed.
+     */
+    QList<LoadResult> loadBatch(const QStringList& paths,
+                                ExifToolProcess::CommandPriority priority = ExifToolProcess::NormalPriority,
+                                const ExifToolProjection& projection      = ExifToolProjection());
+
+    /**
+     * Start to load metadata from a list of files and return immediately. The files are sent to
+     * ExifTool by chunks of batchSize() files, each one parsed in one command. The future reports
+     * the result of the file at index i of the list with resultAt(i), and the number of files
+     * done as progress value. The chunks of a batch larger than batchSize() are parsed in parallel
+     * by a pool of ExifTool processes, one per processor core, without priority.
+     */
+    QFuture<LoadResult> loadBatchAsync(const QStringList& paths,
+                                       ExifToolProcess::CommandPriority priority = ExifToolProcess::NormalPriority,
+                                       const ExifToolProjection& projection      = ExifToolProjection());
+
+    /**
+     * Scan a directory tree with the ExifTool recursive traversal, and return immediately.
+     * Only the files with one of the extensions, without dot, are read; all files supported
+     * by ExifTool if the list is empty. The result of each file is emitted with signalScanResult()
+     * as soon as ExifTool prints it, then signalScanFinished() is emitted.
+     * The scan runs in its own ExifTool process, so the loads are not delayed while it walks the tree.
+     * Return the scan identifier, or 0 if the scan cannot be started.
+     */
+    int  scanDirectory(const QString& dirPath,
+                       const QStringList& extensions            = QStringList(),
+                       const ExifToolProjection& projection     = ExifToolProjection());
+
+    /**
+     * Stop a scan and its ExifTool process. signalScanFinished() is emitted with an error.
+     */
+    bool cancelScan(int scanId);
+
+    /**
+     * Use a persistent cache of the parsed metadata, stored in a file shared with other parsers
+     * and processes. A load of an unchanged file, with the same ExifTool version and options,
+     * is then read from the cache without running ExifTool. The version is read by the shared
+     * process on the first load: the loads sent before are not cached. An empty path disables the cache,
+     * which is the default. Return false if the cache file cannot be used.
+     * Recent results are also kept in memory by ExifToolMemoryCache, checked first,
+     * if it is enabled with ExifToolMemoryCache::setMaxMemory().
+     */
+    bool    setCacheFile(const QString& filePath);
+    QString cacheFile()    const;
+
+    /**
+     * Remove the replaced and stale results from the cache file.
+     */
+    bool    compactCache();
+
+    /**
+     * Set the maximum number of files sent to ExifTool in one command by batch loads.
+     * Default is 32.
+     */
+    void setBatchSize(int size);
+    int  batchSize() const;
+
+    /**
+     * Binary tags, as previews, thumbnails or ICC profiles, are not extracted by load():
+     * their value is an ExifTool placeholder with the data size, as
+     * "(Binary data 2768 bytes, use -b option to extract)".
+     * This method reads the raw bytes of such a tag only, and blocks until done by processing events.
+     * The tag is given as "Tag", "Group:Tag" or as a parsed ExifTool tag name, as "EXIF.IFD1.Image.ThumbnailImage".
+     * Return a null byte array if the tag cannot be read.
+     */
+    QByteArray fetchBinaryTag(const QString& path,
+                              const QString& tag,
+                              ExifToolProcess::CommandPriority priority = ExifToolProcess::NormalPriority);
+
+    /**
+     * Start to read the raw bytes of a binary tag and return immediately.
+     * See fetchBinaryTag() for details.
+     */
+    QFuture<QByteArray> fetchBinaryTagAsync(const QString& path,
+                                            const QString& tag,
+                                            ExifToolProcess::CommandPriority priority = ExifToolProcess::NormalPriority);
 
     /**
      * Turn on/off translations of ExiTool tags to Exiv2.
@@ -75,18 +203,57 @@ public:
      */
     void setTranslations(bool);
 
+    /**
+     * Set the maximum ExifTool execution time of a load, in milliseconds. After this delay,
+     * the load fails and the ExifTool process is restarted. 0 disables the timeout.
+     * Default is 2 minutes.
+     */
+    void setTimeout(int msecs);
+
     QString currentParsedPath()  const;
     TagsMap currentParsedTags()  const;
     TagsMap currentIgnoredTags() const;
     QString currentErrorString() const;
 
+    /**
+     * Return the metrics of the ExifTool process used by the parser, which also
+     * records the JSON parse time of the loads.
+     */
+    ExifToolMetrics* metrics()   const;
+
+Q_SIGNALS:
+
+    /**
+     * Emitted with the metadata of each file read by a scan, in the order of the traversal.
+     */
+    void signalScanResult(int scanId,
+                          const Digikam::ExifToolParser::LoadResult& result);
+
+    /**
+     * Emitted after each file read by a scan, with the number of files read so far.
+     */
+    void signalScanProgress(int scanId, int files);
+
+    /**
+     * Emitted when a scan is complete, or with an error if it failed or was cancelled.
+     */
+    void signalScanFinished(int scanId,
+                            int files,
+                            const QString& errorString);
+
 private Q_SLOTS:
 
+    void slotCmdData(int cmdId,
+                     const QByteArray& cmdOutputChunk);
+
+
     void slotCmdCompleted(int cmdId,
                           int execTime,
                           const QByteArray& cmdOutputChannel,
                           const QByteArray& cmdErrorChannel);
 
+    void slotCmdFailed(int cmdId, ExifToolProcess::CommandError error);
+
     void slotErrorOccurred(QProcess::ProcessError error);
 
     void slotFinished(int exitCode, QProcess::ExitStatus exitStatus);
@@ -95,6 +262,17 @@ private Q_SLOTS:
 
 private:
 
+    QByteArray parseBinaryOutput(const QByteArray& stdOut) const;
+    void parseOutput(const QByteArray& stdOut,
+                     const ExifToolProjection& projection,
+                     QList<LoadResult>& results) const;
+    void parseTag(const char* const key,
+                  int keySize,
+                  const QString& value,
+                  const QString& desc,
+                  const ExifToolProjection& projection,
+                  LoadResult& result) const;
+
     QStringList defaultExifToolSearchPaths() const;
 
 private:
@@ -0,0 +1,550 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : a pool of ExifTool processes with work-stealing dispatch.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "exiftoolpool.h"
+
+// Qt includes
+
+#include <QList>
+#include <QVector>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDebug>
+
+// Local includes
+
+#include "exiftoolprocess.h"
+
+namespace Digikam
+{
+
+class Q_DECL_HIDDEN ExifToolPool::Private
+{
+public:
+
+    struct Command
+    {
+        Command()
+          : id     (0),
+            timeout(0)
+        {
+        }
+
+        int            id;
+        QByteArrayList args;
+        int            timeout;
+    };
+
+    struct Worker
+    {
+        Worker()
+          : proc     (nullptr),
+            runningId(0),
+            procCmdId(0),
+            restart  (false)
+        {
+        }
+
+        ExifToolProcess* proc;
+        QList<Command>   queue;                  ///< Local queue. Owner takes from the front, thieves from the back.
+        int              runningId;              ///< Pool command identifier running on this worker, or 0.
+        int              procCmdId;              ///< Same command as identified by the ExifToolProcess instance.
+        bool             restart;                ///< Closed to run a new program: started again when finished.
+    };
+
+public:
+
+    explicit Private()
+    {
+    }
+
+    /**
+     * Return true if a worker can receive commands: started, closed after the idle timeout,
+     * or restarted with a new program.
+     */
+    bool isAvailable(const Worker& worker) const
+    {
+        return ((worker.proc->state() != QProcess::NotRunning) || worker.proc->isIdleShutdown() || worker.restart);
+    }
+
+    /**
+     * Return the index of the available worker with the lowest load, or -1 if none is available.
+     * An idle worker is always preferred. A starting worker runs its queue when it is started.
+     */
+    int leastLoadedWorker(int excluded = -1) const
+    {
+        int best     = -1;
+        int bestLoad = 0;
+
+        for (int i = 0 ; i < workers.size() ; ++i)
+        {
+            if ((i == excluded) || !isAvailable(workers[i]))
+            {
+                continue;
+            }
+
+            const int load = workers[i].queue.size() + (workers[i].runningId ? 1 : 0);
+
+            if (load == 0)
+            {
+                return i;
+            }
+
+            if ((best == -1) || (load < bestLoad))
+            {
+                best     = i;
+                bestLoad = load;
+            }
+        }
+
+        return best;
+    }
+
+public:
+
+    QVector<Worker>          workers;
+
+    static const int         SHARED_IDLE_TIMEOUT = 60000;
+
+    static ExifToolPool*     s_sharedInstance;      ///< Pool shared by all users of acquireSharedInstance().
+    static int               s_sharedRefs;
+    static QMutex            s_sharedMutex;
+};
+
+ExifToolPool* ExifToolPool::Private::s_sharedInstance = nullptr;
+int           ExifToolPool::Private::s_sharedRefs     = 0;
+QMutex        ExifToolPool::Private::s_sharedMutex;
+
+ExifToolPool::ExifToolPool(int size, QObject* const parent)
+    : QObject(parent),
+      d      (new Private)
+{
+    if (size < 1)
+    {
+        size = qMax(1, QThread::idealThreadCount());
+    }
+
+    d->workers.resize(size);
+
+    for (int i = 0 ; i < size ; ++i)
+    {
+        ExifToolProcess* const proc = new ExifToolProcess();
+        proc->setAutoRestart(true);
+        d->workers[i].proc          = proc;
+
+        connect(proc, &ExifToolProcess::signalCmdCompleted,
+                this, [this, i](int cmdId, int execTime, const QByteArray& out, const QByteArray& err)
+            {
+                slotWorkerCmdCompleted(i, cmdId, execTime, out, err);
+            }
+        );
+
+        connect(proc, &ExifToolProcess::signalCmdFailed,
+                this, [this, i](int cmdId, ExifToolProcess::CommandError error)
+            {
+                slotWorkerCmdFailed(i, cmdId, error);
+            }
+        );
+
+        connect(proc, &ExifToolProcess::signalStarted,
+                this, [this, i]()
+            {
+                dispatch(i);
+            }
+        );
+
+        connect(proc, &ExifToolProcess::signalFinished,
+                this, [this, i](int exitCode, QProcess::ExitStatus exitStatus)
+            {
+                slotWorkerFinished(i, exitCode, exitStatus);
+            }
+        );
+
+        connect(proc, &ExifToolProcess::signalErrorOccurred,
+                this, &ExifToolPool::signalErrorOccurred);
+    }
+}
+
+ExifToolPool::~ExifToolPool()
+{
+    for (int i = 0 ; i < d->workers.size() ; ++i)
+    {
+        d->workers[i].proc->terminate();
+        delete d->workers[i].proc;
+    }
+
+    delete d;
+}
+
+void ExifToolPool::setProgram(const QString& etExePath, const QString& perlExePath)
+{
+    if ((etExePath == program()) && (perlExePath == perlPath()))
+    {
+        return;
+    }
+
+    for (int i = 0 ; i < d->workers.size() ; ++i)
+    {
+        Private::Worker& worker = d->workers[i];
+        worker.proc->setProgram(etExePath, perlExePath);
+
+        // A running worker completes its command with the old program, then is started with the new one.
+
+        if ((worker.proc->state() != QProcess::NotRunning) && !worker.proc->isIdleShutdown())
+        {
+            worker.restart = true;
+            worker.proc->terminate();
+        }
+    }
+}
+
+QString ExifToolPool::program() const
+{
+    return d->workers.first().proc->program();
+}
+
+QString ExifToolPool::perlPath() const
+{
+    return d->workers.first().proc->perlPath();
+}
+
+void ExifToolPool::setIdleTimeout(int msecs)
+{
+    for (int i = 0 ; i < d->workers.size() ; ++i)
+    {
+        d->workers[i].proc->setIdleTimeout(msecs);
+    }
+}
+
+ExifToolPool* ExifToolPool::acquireSharedInstance()
+{
+    QMutexLocker lock(&Private::s_sharedMutex);
+
+    if (!Private::s_sharedInstance)
+    {
+        Private::s_sharedInstance = new ExifToolPool();
+        Private::s_sharedInstance->setIdleTimeout(Private::SHARED_IDLE_TIMEOUT);
+    }
+
+    Private::s_sharedRefs++;
+
+    return Private::s_sharedInstance;
+}
+
+void ExifToolPool::releaseSharedInstance()
+{
+    QMutexLocker lock(&Private::s_sharedMutex);
+
+    if (!Private::s_sharedInstance || (--Private::s_sharedRefs > 0))
+    {
+        return;
+    }
+
+    // Keep the workers warm until the idle timeout, a new user can acquire the pool in the meantime.
+    // The pool is destroyed when its last worker finishes, see slotWorkerFinished().
+
+    if (!Private::s_sharedInstance->isRunning())
+    {
+        Private::s_sharedInstance->deleteLater();
+        Private::s_sharedInstance = nullptr;
+    }
+}
+
+void ExifToolPool::start()
+{
+    for (int i = 0 ; i < d->workers.size() ; ++i)
+    {
+        Private::Worker& worker = d->workers[i];
+
+        if ((worker.proc->state() != QProcess::NotRunning) || worker.proc->isIdleShutdown() || worker.restart)
+        {
+            continue;
+        }
+
+        worker.queue.clear();
+        worker.runningId = 0;
+        worker.procCmdId = 0;
+        worker.proc->start();
+    }
+}
+
+bool ExifToolPool::waitForStarted(int msecs) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0 ; i < d->workers.size() ; ++i)
+    {
+        d->workers[i].proc->waitForStarted(qMax(0, msecs - (int)timer.elapsed()));
+    }
+
+    return isRunning();
+}
+
+int ExifToolPool::size() const
+{
+    return d->workers.size();
+}
+
+bool ExifToolPool::isRunning() const
+{
+    for (int i = 0 ; i < d->workers.size() ; ++i)
+    {
+        if (d->workers[i].proc->isRunning())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ExifToolPool::isBusy() const
+{
+    for (int i = 0 ; i < d->workers.size() ; ++i)
+    {
+        if (d->workers[i].runningId || !d->workers[i].queue.isEmpty())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int ExifToolPool::command(const QByteArrayList& args, int timeout)
+{
+    const int index = d->leastLoadedWorker();
+
+    if ((index == -1) || args.isEmpty())
+    {
+        qWarning() << "ExifToolPool::command(): cannot process command with ExifTool" << args;
+        return 0;
+    }
+
+    Private::Command command;
+    command.id      = ExifToolProcess::nextCmdId();
+    command.args    = args;
+    command.timeout = timeout;
+    d->workers[index].queue.append(command);
+
+    dispatch(index);
+
+    return command.id;
+}
+
+bool ExifToolPool::cancel(int cmdId)
+{
+    for (int i = 0 ; i < d->workers.size() ; ++i)
+    {
+        Private::Worker& worker = d->workers[i];
+
+        if (cmdId == worker.runningId)
+        {
+            // Reported by slotWorkerCmdFailed() with the identifier of the pool.
+
+            return worker.proc->cancel(worker.procCmdId);
+        }
+
+        for (int c = 0 ; c < worker.queue.size() ; ++c)
+        {
+            if (worker.queue[c].id == cmdId)
+            {
+                worker.queue.removeAt(c);
+                emit signalCmdFailed(cmdId, ExifToolProcess::CommandCancelled);
+
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void ExifToolPool::terminate()
+{
+    for (int i = 0 ; i < d->workers.size() ; ++i)
+    {
+        d->workers[i].queue.clear();
+        d->workers[i].proc->terminate();
+    }
+}
+
+void ExifToolPool::kill()
+{
+    for (int i = 0 ; i < d->workers.size() ; ++i)
+    {
+        d->workers[i].queue.clear();
+        d->workers[i].proc->kill();
+    }
+}
+
+void ExifToolPool::dispatch(int index)
+{
+    Private::Worker& worker = d->workers[index];
+
+    // A worker closed after the idle timeout is started again by its next command.
+
+    if (worker.runningId || worker.restart || !(worker.proc->isRunning() || worker.proc->isIdleShutdown()))
+    {
+        return;
+    }
+
+    if (worker.queue.isEmpty())
+    {
+        // Nothing to do locally: steal the most recent command from the busiest worker.
+
+        int victim = -1;
+        int most   = 0;
+
+        for (int i = 0 ; i < d->workers.size() ; ++i)
+        {
+            if ((i != index) && (d->workers[i].queue.size() > most))
+            {
+                victim = i;
+                most   = d->workers[i].queue.size();
+            }
+        }
+
+        if (victim == -1)
+        {
+            return;
+        }
+
+        worker.queue.append(d->workers[victim].queue.takeLast());
+    }
+
+    Private::Command command = worker.queue.takeFirst();
+    const int procCmdId      = worker.proc->command(command.args, ExifToolProcess::NoCommandFlags, command.timeout);
+
+    if (procCmdId == 0)
+    {
+        worker.queue.prepend(command);
+        return;
+    }
+
+    worker.runningId = command.id;
+    worker.procCmdId = procCmdId;
+}
+
+void ExifToolPool::slotWorkerCmdCompleted(int index,
+                                          int cmdId,
+                                          int execTime,
+                                          const QByteArray& cmdOutputChannel,
+                                          const QByteArray& cmdErrorChannel)
+{
+    Private::Worker& worker = d->workers[index];
+
+    if (cmdId != worker.procCmdId)
+    {
+        qCritical() << "ExifToolPool: Sync error between worker" << index
+                    << "command (" << worker.procCmdId << ") and completed command (" << cmdId << ")";
+        return;
+    }
+
+    const int poolCmdId = worker.runningId;
+    worker.runningId    = 0;
+    worker.procCmdId    = 0;
+
+    emit signalCmdCompleted(poolCmdId, execTime, cmdOutputChannel, cmdErrorChannel);
+
+    dispatch(index);
+}
+
+void ExifToolPool::slotWorkerCmdFailed(int index, int cmdId, ExifToolProcess::CommandError error)
+{
+    Private::Worker& worker = d->workers[index];
+
+    if (cmdId != worker.procCmdId)
+    {
+        return;
+    }
+
+    const int poolCmdId = worker.runningId;
+    worker.runningId    = 0;
+    worker.procCmdId    = 0;
+
+    emit signalCmdFailed(poolCmdId, error);
+
+    dispatch(index);
+}
+
+void ExifToolPool::slotWorkerFinished(int index, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    // A worker closed to change the program keeps its queue, run when it is started again.
+
+    if (d->workers[index].restart)
+    {
+        d->workers[index].restart = false;
+        d->workers[index].proc->start();
+
+        return;
+    }
+
+    // Hand over pending commands to the other workers. With auto-restart, the running command
+    // is replayed by the worker process or reported with signalCmdFailed(), otherwise it is lost.
+
+    QList<Private::Command> orphans = d->workers[index].queue;
+    d->workers[index].queue.clear();
+
+    if (!d->workers[index].proc->autoRestart())
+    {
+        d->workers[index].runningId = 0;
+        d->workers[index].procCmdId = 0;
+    }
+
+    for (const Private::Command& command : orphans)
+    {
+        const int target = d->leastLoadedWorker(index);
+
+        if (target == -1)
+        {
+            qWarning() << "ExifToolPool: no worker left to process command" << command.id;
+            emit signalCmdFailed(command.id, ExifToolProcess::CommandDropped);
+
+            continue;
+        }
+
+        d->workers[target].queue.append(command);
+        dispatch(target);
+    }
+
+    if (!isRunning())
+    {
+        emit signalFinished(exitCode, exitStatus);
+
+        // The shared pool is not used anymore and is now stopped: release it.
+
+        QMutexLocker lock(&Private::s_sharedMutex);
+
+        if ((this == Private::s_sharedInstance) && (Private::s_sharedRefs <= 0))
+        {
+            Private::s_sharedInstance = nullptr;
+            deleteLater();
+        }
+    }
+}
+
+} // namespace Digikam
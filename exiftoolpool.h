@@ -0,0 +1,190 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : a pool of ExifTool processes with work-stealing dispatch.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_EXIFTOOL_POOL_H
+#define DIGIKAM_EXIFTOOL_POOL_H
+
+// Qt Core
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QProcess>
+
+// Local includes
+
+#include "exiftoolprocess.h"
+
+namespace Digikam
+{
+
+/**
+ * ExifToolPool owns several ExifToolProcess instances running in stay_open mode,
+ * and dispatches commands to them. Each worker executes one command at a time.
+ * Commands are queued on the least loaded worker, and a worker which becomes idle
+ * steals pending commands from the busiest one.
+ *
+ * The pool exposes the same command() / signalCmdCompleted() contract as ExifToolProcess,
+ * so it can be used as a drop-in replacement to parallelize metadata extraction.
+ */
+class ExifToolPool : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * Constructs a pool of 'size' ExifTool processes with the given parent.
+     * If size is lower than 1, the number of processor cores is used.
+     */
+    explicit ExifToolPool(int size = 0, QObject* const parent = nullptr);
+
+    /**
+     * Destructs the pool, i.e., killing all processes.
+     */
+    ~ExifToolPool();
+
+    /**
+     * Return the process-wide pool, with one worker per processor core, creating it on first call.
+     * Its workers are closed after an idle timeout, and started again on the next command.
+     * Each call must be balanced with releaseSharedInstance(), the pool is destroyed when
+     * it is not referenced anymore and its workers are stopped.
+     * The pool must be used from the thread which created it.
+     */
+    static ExifToolPool* acquireSharedInstance();
+    static void          releaseSharedInstance();
+
+public:
+
+    /**
+     * Setup the ExifTool configuration of all workers. Running workers are restarted
+     * with the new program when their current command is completed.
+     */
+    void setProgram(const QString& etExePath,
+                    const QString& perlExePath = QString());
+
+    QString program()  const;
+    QString perlPath() const;
+
+    /**
+     * Close the workers when no command was sent during msecs milliseconds, see ExifToolProcess::setIdleTimeout().
+     */
+    void setIdleTimeout(int msecs);
+
+    /**
+     * Starts the ExifTool processes not running yet. Workers closed after the idle timeout
+     * are left stopped: they are started again by their next command.
+     */
+    void start();
+
+    /**
+     * Blocks until all processes have started, or until msecs milliseconds have passed.
+     * Return true if at least one process is running.
+     */
+    bool waitForStarted(int msecs = 30000) const;
+
+    /**
+     * Return the number of workers hosted by the pool.
+     */
+    int  size()                             const;
+
+    /**
+     * Return true if at least one worker is running.
+     */
+    bool isRunning()                        const;
+
+    /**
+     * Return true if at least one command is running or pending.
+     */
+    bool isBusy()                           const;
+
+    /**
+     * Send a command to an ExifTool process of the pool. A command sent while the processes
+     * are starting is dispatched when one of them is started. The command is killed and
+     * reported with signalCmdFailed() if its execution takes more than timeout milliseconds.
+     * Return 0: no ExifTool process started or args is empty.
+     */
+    int command(const QByteArrayList& args, int timeout = 0);
+
+    /**
+     * Cancel a command. A pending command is removed from the queue of its worker. The command
+     * being executed cannot be interrupted: the worker process is restarted.
+     * signalCmdFailed() is emitted with CommandCancelled.
+     * Return false if the command is unknown or already completed.
+     */
+    bool cancel(int cmdId);
+
+public Q_SLOTS:
+
+    /**
+     * Attempts to terminate all processes. Pending commands are dropped.
+     */
+    void terminate();
+
+    /**
+     * Kills all processes, causing them to exit immediately.
+     */
+    void kill();
+
+Q_SIGNALS:
+
+    void signalErrorOccurred(QProcess::ProcessError error);
+
+    /**
+     * Emitted when the last running process of the pool has finished.
+     */
+    void signalFinished(int exitCode,
+                        QProcess::ExitStatus exitStatus);
+
+    void signalCmdCompleted(int cmdId,
+                            int execTime,
+                            const QByteArray& cmdOutputChannel,
+                            const QByteArray& cmdErrorChannel);
+
+    void signalCmdFailed(int cmdId,
+                         Digikam::ExifToolProcess::CommandError error);
+
+private:
+
+    void dispatch(int index);
+    void slotWorkerCmdCompleted(int index,
+                                int cmdId,
+                                int execTime,
+                                const QByteArray& cmdOutputChannel,
+                                const QByteArray& cmdErrorChannel);
+    void slotWorkerCmdFailed(int index,
+                             int cmdId,
+                             ExifToolProcess::CommandError error);
+    void slotWorkerFinished(int index,
+                            int exitCode,
+                            QProcess::ExitStatus exitStatus);
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_EXIFTOOL_POOL_H
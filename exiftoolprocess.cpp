@@ -31,233 +31,1557 @@
 #include <QFile>
 #include <QElapsedTimer>
 #include <QList>
+#include <QHash>
+#include <QPair>
 #include <QByteArray>
+#include <QMutexLocker>
+#include <QTimer>
+#include <QFutureInterface>
+#include <QAtomicPointer>
+#include <QAtomicInt>
+#include <QWaitCondition>
+#include <QThread>
+#include <QStringList>
 #include <QDebug>
 
+// Local includes
+
+#include "exiftooljsonsplitter.h"
+#include "exiftooloutputframer.h"
+#include "exiftoolcommandtemplate.h"
+#include "exiftoolmetrics.h"
+
 namespace Digikam
 {
 
-class Q_DECL_HIDDEN ExifToolProcess::Private
+class Q_DECL_HIDDEN ExifToolProcess::Private
+{
+public:
+
+    static const int NB_PRIORITIES  = 3;
+    static const int AGING_INTERVAL = 2000;          ///< In milliseconds.
+    static const int AGING_BURST    = 4;
+
+public:
+
+    struct Command
+    {
+        Command()
+          : id       (0),
+            flags    (NoCommandFlags),
+            priority (NormalPriority),
+            timeout  (0),
+            retries  (0),
+            cancelled(false),
+            answered (false)
+        {
+        }
+
+        int           id;
+        CommandFlags  flags;
+        CommandPriority priority;
+        int           timeout;                  ///< Maximum execution time in milliseconds, 0 for none.
+        int           retries;                  ///< Number of times the command was replayed after a crash.
+        bool          cancelled;                ///< Cancelled while written to ExifTool: output is discarded.
+        bool          answered;                 ///< First output byte received and recorded in the metrics.
+        QByteArray    argsStr;
+        ExifToolCommandTemplate cmdTemplate;    ///< Options, only kept for CoalesceFiles commands to merge them.
+        QByteArray    file;                     ///< File name, only kept for CoalesceFiles commands.
+        QList<Command> members;                 ///< Commands merged in this execution, which completes them.
+        QElapsedTimer queueTimer;               ///< Started when the command is queued.
+        QElapsedTimer execTimer;
+    };
+
+    /**
+     * Pending commands, with one FIFO per priority class. The next command is taken from
+     * the highest class. For aging, when the oldest command of a lower class waited more than
+     * AGING_INTERVAL, one command out of AGING_BURST + 1 is taken from it, so a continuous flow
+     * of high priority commands cannot starve background work.
+     */
+    class CommandQueue
+    {
+    public:
+
+        CommandQueue()
+          : strictPicks(0)
+        {
+        }
+
+        void append(const Command& cmd)
+        {
+            queues[cmd.priority].append(cmd);
+        }
+
+        /**
+         * Put back a command at the head of its class.
+         */
+        void prepend(const Command& cmd)
+        {
+            queues[cmd.priority].prepend(cmd);
+        }
+
+        Command takeNext()
+        {
+            int top = 0;
+
+            while (queues[top].isEmpty())
+            {
+                ++top;
+            }
+
+            int    aged   = -1;
+            qint64 oldest = AGING_INTERVAL;
+
+            for (int p = top + 1 ; p < NB_PRIORITIES ; ++p)
+            {
+                if (!queues[p].isEmpty() && (queues[p].first().queueTimer.elapsed() >= oldest))
+                {
+                    aged   = p;
+                    oldest = queues[p].first().queueTimer.elapsed();
+                }
+            }
+
+            if (aged == -1)
+            {
+                strictPicks = 0;
+            }
+            else if (++strictPicks > AGING_BURST)
+            {
+                strictPicks = 0;
+
+                return queues[aged].takeFirst();
+            }
+
+            return queues[top].takeFirst();
+        }
+
+        bool takeCommand(int cmdId, Command& cmd)
+        {
+            for (int p = 0 ; p < NB_PRIORITIES ; ++p)
+            {
+                for (int i = 0 ; i < queues[p].size() ; ++i)
+                {
+                    if (queues[p][i].id == cmdId)
+                    {
+                        cmd = queues[p].takeAt(i);
+
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * Take up to max pending commands which can be merged with cmd in one execution.
+         * Only the class of cmd is searched, so merging never promotes a command.
+         */
+        QList<Command> takeCoalescible(const Command& cmd, int max)
+        {
+            QList<Command> similar;
+            QList<Command>& queue = queues[cmd.priority];
+
+            for (int i = 0 ; (i < queue.size()) && (similar.size() < max) ; )
+            {
+                if (isCoalescible(queue[i], cmd))
+                {
+                    similar << queue.takeAt(i);
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+
+            return similar;
+        }
+
+        static bool isCoalescible(const Command& a, const Command& b)
+        {
+            // All arguments except the file name must be identical.
+
+            return ((a.flags & CoalesceFiles) && !(a.flags & StreamOutput) &&
+                    (a.flags == b.flags)      && !a.retries && !b.retries  &&
+                    !a.file.isEmpty()         && !b.file.isEmpty()         &&
+                    a.cmdTemplate.hasSameOptions(b.cmdTemplate));
+        }
+
+        QList<Command> takeAll()
+        {
+            QList<Command> all;
+
+            for (int p = 0 ; p < NB_PRIORITIES ; ++p)
+            {
+                all << queues[p];
+                queues[p].clear();
+            }
+
+            return all;
+        }
+
+        bool isEmpty() const
+        {
+            return (size() == 0);
+        }
+
+        int size() const
+        {
+            int count = 0;
+
+            for (int p = 0 ; p < NB_PRIORITIES ; ++p)
+            {
+                count += queues[p].size();
+            }
+
+            return count;
+        }
+
+        int size(CommandPriority priority) const
+        {
+            return queues[priority].size();
+        }
+
+        /**
+         * Return the number of commands which are sent before a new command of this priority.
+         */
+        int sizeAhead(CommandPriority priority) const
+        {
+            int count = 0;
+
+            for (int p = 0 ; p <= priority ; ++p)
+            {
+                count += queues[p].size();
+            }
+
+            return count;
+        }
+
+    private:
+
+        QList<Command> queues[NB_PRIORITIES];
+        int            strictPicks;             ///< Consecutive commands taken from a higher class while a lower one is aged.
+    };
+
+    /**
+     * A command submitted from any thread with submit(), waiting in the lock-free queue.
+     */
+    struct Submission
+    {
+        Submission()
+          : priority(NormalPriority)
+        {
+        }
+
+        QAtomicPointer<Submission>      next;
+        QByteArrayList                  args;
+        CommandPriority                 priority;
+        QFutureInterface<CommandResult> promise;
+    };
+
+public:
+
+    explicit Private(ExifToolProcess* const qq)
+      : q                   (qq),
+        process             (nullptr),
+        pipelineDepth       (1),
+        maxCoalescedFiles   (32),
+        idleTimer           (nullptr),
+        idleTimeout         (0),
+        idleShutdown        (false),
+        deadlineTimer       (nullptr),
+        restartPending      (false),
+        autoRestart         (false),
+        stopRequested       (false),
+        maxRetries          (1),
+        respawnTimer        (nullptr),
+        respawnDelay        (RESPAWN_MIN_DELAY),
+        respawnCount        (0),
+        highWater           (0),
+        lowWater            (0),
+        rejectWhenFull      (false),
+        deadlineAdmission   (false),
+        avgExecTime         (0.0),
+        lastRejected        (false),
+        hotStandby          (false),
+        standby             (nullptr),
+        standbyReady        (false),
+        submitHead          (&submitStub),
+        submitTail          (&submitStub),
+        writeChannelIsClosed(true),
+        processError        (QProcess::UnknownError)
+    {
+    }
+
+    /**
+     * Merge pending commands similar to cmd in cmd, which becomes one execution with a list of files.
+     */
+    void coalesce(Command& cmd)
+    {
+        if ((maxCoalescedFiles < 2) || !CommandQueue::isCoalescible(cmd, cmd))
+        {
+            return;
+        }
+
+        const QList<Command> similar = cmdQueue.takeCoalescible(cmd, maxCoalescedFiles - 1);
+
+        if (similar.isEmpty())
+        {
+            return;
+        }
+
+        Command merged;
+        merged.id         = ExifToolProcess::nextCmdId();
+        merged.priority   = cmd.priority;
+        merged.queueTimer = cmd.queueTimer;
+        merged.members   << cmd << similar;
+
+        // The execution deadline is the sum of the members timeouts, the timeout of one file multiplied
+        // by the number of files for similar commands, or none if one of them has none.
+
+        QByteArrayList files;
+        bool bounded = true;
+
+        for (const Command& member : merged.members)
+        {
+            files          << member.file;
+            bounded         = bounded && (member.timeout > 0);
+            merged.timeout += member.timeout;
+        }
+
+        merged.timeout = bounded ? merged.timeout : 0;
+        merged.argsStr = cmd.cmdTemplate.serialize(merged.id, files);
+        cmd            = merged;
+    }
+
+    /**
+     * Multiple producers side of the submission queue (intrusive MPSC queue
+     * from Dmitry Vyukov): callable from any thread, without lock.
+     */
+    void pushSubmission(Submission* const node)
+    {
+        node->next.storeRelease(nullptr);
+        Submission* const prev = submitHead.fetchAndStoreOrdered(node);
+        prev->next.storeRelease(node);
+    }
+
+    /**
+     * Single consumer side of the submission queue, only called from the owner thread.
+     * Return nullptr if the queue is empty, or if a producer is still linking its node.
+     */
+    Submission* popSubmission()
+    {
+        Submission* tail = submitTail;
+        Submission* next = tail->next.loadAcquire();
+
+        if (tail == &submitStub)
+        {
+            if (!next)
+            {
+                return nullptr;
+            }
+
+            submitTail = next;
+            tail       = next;
+            next       = next->next.loadAcquire();
+        }
+
+        if (next)
+        {
+            submitTail = next;
+
+            return tail;
+        }
+
+        if (tail != submitHead.loadAcquire())
+        {
+            return nullptr;
+        }
+
+        pushSubmission(&submitStub);
+        next = tail->next.loadAcquire();
+
+        if (next)
+        {
+            submitTail = next;
+
+            return tail;
+        }
+
+        return nullptr;
+    }
+
+    bool hasSubmissions() const
+    {
+        return ((submitTail != &submitStub) || submitTail->next.loadAcquire());
+    }
+
+    /**
+     * Deliver the result of a command to its submit() caller, if any.
+     */
+    void finishPromise(int cmdId, const CommandResult& result)
+    {
+        QHash<int, QFutureInterface<CommandResult> >::iterator it = promises.find(cmdId);
+
+        if (it == promises.end())
+        {
+            return;
+        }
+
+        it.value().reportResult(result);
+        it.value().reportFinished();
+        promises.erase(it);
+    }
+
+    /**
+     * Report a command which will never be completed to its submit() caller and with signalCmdFailed().
+     */
+    void failCommand(const Command& cmd, CommandError error)
+    {
+        if (!cmd.members.isEmpty())
+        {
+            for (const Command& member : cmd.members)
+            {
+                failCommand(member, error);
+            }
+
+            return;
+        }
+
+        outChannel[QProcess::StandardOutput].streamIds.remove(cmd.id);
+        metrics.increment(ExifToolMetrics::FailedCommands);
+
+        CommandResult result;
+        result.cmdId   = cmd.id;
+        result.failure = error;
+        finishPromise(cmd.id, result);
+
+        if (!cmd.cancelled)
+        {
+            emit q->signalCmdFailed(cmd.id, error);
+        }
+    }
+
+    /**
+     * Deliver the result of a completed command to its submit() caller and with signalCmdCompleted().
+     */
+    void reportCompleted(int cmdId, int execTime, const QByteArray& out, const QByteArray& err)
+    {
+        CommandResult result;
+        result.cmdId     = cmdId;
+        result.execTime  = execTime;
+        result.completed = true;
+        result.failure   = NoCommandError;
+        result.output    = out;
+        result.error     = err;
+        finishPromise(cmdId, result);
+        metrics.increment(ExifToolMetrics::Commands);
+
+        emit q->signalCmdCompleted(cmdId, execTime, out, err);
+    }
+
+    /**
+     * Deliver the outputs of a completed execution to its command, or split them between
+     * the merged commands: each one receives the JSON object of its file, and the error
+     * lines which name it.
+     */
+    void completeCommand(const Command& cmd, int execTime, const QByteArray& out, const QByteArray& err)
+    {
+        if (cmd.members.isEmpty())
+        {
+            if (!cmd.cancelled)
+            {
+                reportCompleted(cmd.id, execTime, out, err);
+            }
+
+            return;
+        }
+
+        const QList<QByteArray> objects  = ExifToolJsonSplitter::split(out);
+        const QList<QByteArray> errLines = err.split('\n');
+        QList<bool>             used;
+        QStringList             sources;
+
+        for (const QByteArray& object : objects)
+        {
+            // ExifTool reports source files with '/' separators on all platforms.
+
+            sources << ExifToolJsonSplitter::sourceFile(object).replace(QLatin1Char('\\'), QLatin1Char('/'));
+            used    << false;
+        }
+
+        for (int m = 0 ; m < cmd.members.size() ; ++m)
+        {
+            const Command& member = cmd.members[m];
+            const QByteArray& file = member.file;
+            const QString path     = QString::fromUtf8(file).replace(QLatin1Char('\\'), QLatin1Char('/'));
+            int index              = sources.indexOf(path);
+
+            while ((index != -1) && used[index])
+            {
+                index = sources.indexOf(path, index + 1);
+            }
+
+            // Fallback when the path was rewritten: objects are in the order of the files.
+
+            if ((index == -1) && (objects.size() == cmd.members.size()) && !used[m])
+            {
+                index = m;
+            }
+
+            QByteArray memberOut;
+
+            if (index != -1)
+            {
+                used[index] = true;
+                memberOut   = QByteArray("[") + objects[index] + QByteArray("]");
+            }
+
+            QByteArray memberErr;
+
+            for (const QByteArray& line : errLines)
+            {
+                if (line.contains(file) || line.contains(path.toUtf8()))
+                {
+                    memberErr.append(line + '\n');
+                }
+            }
+
+            if (!member.cancelled)
+            {
+                reportCompleted(member.id, execTime, memberOut, memberErr);
+            }
+        }
+    }
+
+    /**
+     * Drop a list of commands which will never be completed.
+     */
+    void abortCommands(QList<Command>& commands, CommandError error = CommandDropped)
+    {
+        const QList<Command> dropped = commands;
+        commands.clear();
+
+        for (const Command& cmd : dropped)
+        {
+            failCommand(cmd, error);
+        }
+    }
+
+    void abortCommands(CommandQueue& queue, CommandError error = CommandDropped)
+    {
+        QList<Command> dropped = queue.takeAll();
+        updateQueueLevel();
+        abortCommands(dropped, error);
+    }
+
+    /**
+     * Publish the queue level to the producers threads, and emit signalQueueFull() or
+     * signalQueueDrained() when it crosses the high or the low water mark.
+     */
+    void updateQueueLevel()
+    {
+        queued.storeRelease(cmdQueue.size());
+
+        if (!highWater)
+        {
+            return;
+        }
+
+        const int level = cmdQueue.size() + submitted.loadAcquire();
+
+        if      (!queueFull.loadAcquire() && (level >= highWater))
+        {
+            queueFull.storeRelease(1);
+
+            emit q->signalQueueFull();
+        }
+        else if (queueFull.loadAcquire() && (level <= lowWater))
+        {
+            queueFull.storeRelease(0);
+
+            emit q->signalQueueDrained();
+        }
+
+        if (!queueFull.loadAcquire() && spaceWaiters.loadAcquire())
+        {
+            QMutexLocker lock(&spaceMutex);
+            spaceAvailable.wakeAll();
+        }
+    }
+
+    /**
+     * Return true if a producer must wait before submitting a new command.
+     */
+    bool mustWaitForSpace() const
+    {
+        return (highWater &&
+                (queueFull.loadAcquire() ||
+                 ((queued.loadAcquire() + submitted.loadAcquire()) >= highWater)));
+    }
+
+    /**
+     * Return the estimated delay in milliseconds before a new command of this priority starts,
+     * from the mean execution time of the previous commands.
+     */
+    qint64 estimatedWaitTime(CommandPriority priority) const
+    {
+        return (qint64)(avgExecTime * (cmdInFlight.size() + cmdQueue.sizeAhead(priority)));
+    }
+
+    /**
+     * Return the position of the command identified by cmdId in the in-flight list, or -1.
+     */
+    int inFlightIndex(int cmdId) const
+    {
+        for (int i = 0 ; i < cmdInFlight.size() ; ++i)
+        {
+            if (cmdInFlight[i].id == cmdId)
+            {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    /**
+     * Return true if a channel has completed outputs for other commands than cmdId.
+     */
+    bool hasOtherOutputs(int channel, int cmdId) const
+    {
+        return (outChannel[channel].done.size() > (outChannel[channel].done.contains(cmdId) ? 1 : 0));
+    }
+
+public:
+
+    ExifToolProcess*       q;
+
+    QString                etExePath;
+    QString                perlExePath;
+    QByteArrayList         commonArgs;              ///< Options appended to all commands with -common_args.
+    QProcess*              process;
+
+    CommandQueue           cmdQueue;                ///< Commands waiting to be written to ExifTool.
+    QList<Command>         cmdInFlight;             ///< Commands written to ExifTool, in execution order.
+    int                    pipelineDepth;           ///< Maximum size of cmdInFlight.
+    int                    maxCoalescedFiles;       ///< Maximum number of commands merged in one execution.
+
+    ExifToolOutputFramer   outChannel[2];           ///< [0] StandardOutput | [1] ErrorOutput
+
+    QTimer*                idleTimer;
+    int                    idleTimeout;             ///< In milliseconds, 0 to disable.
+    bool                   idleShutdown;            ///< Process was terminated after the idle timeout.
+
+    QTimer*                deadlineTimer;           ///< Fires when the running command exceeds its timeout.
+    bool                   restartPending;          ///< Process was killed and must be started again when finished.
+
+    bool                   autoRestart;             ///< Start the process again when it exits unexpectedly.
+    bool                   stopRequested;           ///< Process exit was requested with terminate() or kill().
+    int                    maxRetries;              ///< Number of replays of the command running during a crash.
+    QTimer*                respawnTimer;
+    int                    respawnDelay;            ///< Next respawn delay in milliseconds, doubled on each crash.
+    int                    respawnCount;            ///< Consecutive respawns without any completed command.
+
+    bool                   hotStandby;              ///< Keep a warm process ready to replace the active one.
+    QProcess*              standby;                 ///< Pre-started process, or nullptr.
+    bool                   standbyReady;            ///< The standby process answered its warm-up command.
+    QByteArray             standbyOutput;           ///< Warm-up output received so far.
+
+    QAtomicPointer<Submission> submitHead;          ///< Producers side of the submission queue.
+    Submission*            submitTail;              ///< Consumer side of the submission queue.
+    Submission             submitStub;
+    QAtomicInt             drainScheduled;          ///< 1 if slotDrainSubmissions() is already queued.
+    QHash<int, QFutureInterface<CommandResult> > promises;  ///< submit() results by command id.
+
+    bool                   writeChannelIsClosed;
+
+    QProcess::ProcessError processError;
+    QString                errorString;
+
+    ExifToolMetrics        metrics;
+
+    int                    highWater;               ///< Queue size which makes the queue full, 0 for unbounded.
+    int                    lowWater;                ///< Queue size which makes a full queue drained.
+    bool                   rejectWhenFull;          ///< command() fails when the queue is full.
+    bool                   deadlineAdmission;       ///< command() fails when its timeout cannot be met.
+    double                 avgExecTime;             ///< Moving average of the execution time, in milliseconds.
+    bool                   lastRejected;            ///< Last command() failed because of the admission control.
+    QAtomicInt             queueFull;               ///< 1 between signalQueueFull() and signalQueueDrained().
+    QAtomicInt             queued;                  ///< Size of cmdQueue, readable from any thread.
+    QAtomicInt             submitted;               ///< Submissions not yet drained to cmdQueue.
+    QAtomicInt             spaceWaiters;            ///< Threads blocked in waitForQueueSpace().
+    QMutex                 spaceMutex;
+    QWaitCondition         spaceAvailable;
+
+public:
+
+    static const int       CMD_ID_MIN  = 1;
+    static const int       CMD_ID_MAX  = 2000000000;
+
+    static int             s_nextCmdId;               ///< Unique identifier, even in a multi-instances or multi-thread environment
+    static QMutex          s_cmdIdMutex;
+
+    static const int       SHARED_IDLE_TIMEOUT  = 60000;
+
+    /// Commands written ahead by the shared instance: enough to hide the pipe round-trip between
+    /// small loads, low enough for an interactive load not to wait behind many queued ones.
+    static const int       SHARED_PIPELINE_DEPTH = 4;
+
+    static const int       RESPAWN_MIN_DELAY    = 100;
+    static const int       RESPAWN_MAX_DELAY    = 10000;
+    static const int       RESPAWN_MAX_ATTEMPTS = 8;
+
+    static ExifToolProcess* s_sharedInstance;         ///< Process shared by all users of acquireSharedInstance().
+    static int             s_sharedRefs;
+    static QMutex          s_sharedMutex;
+};
+
+QMutex           ExifToolProcess::Private::s_cmdIdMutex;
+int              ExifToolProcess::Private::s_nextCmdId       = ExifToolProcess::Private::CMD_ID_MIN;
+ExifToolProcess* ExifToolProcess::Private::s_sharedInstance  = nullptr;
+int              ExifToolProcess::Private::s_sharedRefs      = 0;
+QMutex           ExifToolProcess::Private::s_sharedMutex;
+
+ExifToolProcess::ExifToolProcess(QObject* const parent)
+    : QObject(parent),
+      d      (new Private(this))
+{
+    d->process = new QProcess(this);
+/*
+    d->process->setProcessEnvironment(adjustedEnvironmentForAppImage());
+*/
+    connectProcess(d->process);
+
+    d->idleTimer = new QTimer(this);
+    d->idleTimer->setSingleShot(true);
+
+    connect(d->idleTimer, &QTimer::timeout,
+            this, &ExifToolProcess::slotIdleTimeout);
+
+    d->deadlineTimer = new QTimer(this);
+    d->deadlineTimer->setSingleShot(true);
+
+    connect(d->deadlineTimer, &QTimer::timeout,
+            this, &ExifToolProcess::slotDeadlineExceeded);
+
+    d->respawnTimer = new QTimer(this);
+    d->respawnTimer->setSingleShot(true);
+
+    connect(d->respawnTimer, &QTimer::timeout,
+            this, &ExifToolProcess::slotRespawn);
+}
+
+ExifToolProcess::~ExifToolProcess()
+{
+    blockSignals(true);
+
+    d->abortCommands(d->cmdQueue);
+    d->abortCommands(d->cmdInFlight);
+
+    while (Private::Submission* const node = d->popSubmission())
+    {
+        node->promise.reportResult(CommandResult());
+        node->promise.reportFinished();
+        delete node;
+    }
+
+    delete d;
+}
+
+void ExifToolProcess::connectProcess(QProcess* const process)
+{
+    connect(process, &QProcess::started,
+            this, &ExifToolProcess::slotStarted);
+
+#if QT_VERSION >= 0x060000
+
+    connect(process, &QProcess::finished,
+            this, &ExifToolProcess::slotFinished);
+
+#else
+
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &ExifToolProcess::slotFinished);
+
+#endif
+
+    connect(process, &QProcess::stateChanged,
+            this, &ExifToolProcess::slotStateChanged);
+
+    connect(process, &QProcess::errorOccurred,
+            this, &ExifToolProcess::slotErrorOccurred);
+
+    connect(process, &QProcess::readyReadStandardOutput,
+            this, &ExifToolProcess::slotReadyReadStandardOutput);
+
+    connect(process, &QProcess::readyReadStandardError,
+            this, &ExifToolProcess::slotReadyReadStandardError);
+}
+
+void ExifToolProcess::disconnectProcess(QProcess* const process)
+{
+    disconnect(process, nullptr, this, nullptr);
+}
+
+void ExifToolProcess::retireProcess(QProcess* const process)
+{
+    // Detached from this instance: kill it and delete it when it is finished.
+
+    disconnectProcess(process);
+
+    if (process->state() == QProcess::NotRunning)
+    {
+        process->deleteLater();
+
+        return;
+    }
+
+#if QT_VERSION >= 0x060000
+
+    connect(process, &QProcess::finished,
+            process, &QObject::deleteLater);
+
+#else
+
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            process, &QObject::deleteLater);
+
+#endif
+
+    process->kill();
+}
+
+ExifToolProcess* ExifToolProcess::acquireSharedInstance()
+{
+    QMutexLocker lock(&Private::s_sharedMutex);
+
+    if (!Private::s_sharedInstance)
+    {
+        Private::s_sharedInstance = new ExifToolProcess();
+        Private::s_sharedInstance->setIdleTimeout(Private::SHARED_IDLE_TIMEOUT);
+        Private::s_sharedInstance->setAutoRestart(true);
+        Private::s_sharedInstance->setHotStandby(true);
+        Private::s_sharedInstance->setPipelineDepth(Private::SHARED_PIPELINE_DEPTH);
+    }
+
+    Private::s_sharedRefs++;
+
+    return Private::s_sharedInstance;
+}
+
+void ExifToolProcess::releaseSharedInstance()
+{
+    QMutexLocker lock(&Private::s_sharedMutex);
+
+    if (!Private::s_sharedInstance || (--Private::s_sharedRefs > 0))
+    {
+        return;
+    }
+
+    ExifToolProcess* const proc = Private::s_sharedInstance;
+
+    if (proc->d->process->state() == QProcess::NotRunning)
+    {
+        Private::s_sharedInstance = nullptr;
+        proc->deleteLater();
+
+        return;
+    }
+
+    // Keep the process warm until the idle timeout, a new user can acquire it in the meantime.
+    // The instance is destroyed when the process finishes, see slotFinished().
+
+    if (!proc->isBusy() && proc->d->cmdQueue.isEmpty())
+    {
+        proc->d->idleTimer->start(proc->d->idleTimeout);
+    }
+}
+
+void ExifToolProcess::setIdleTimeout(int msecs)
+{
+    d->idleTimeout = qMax(0, msecs);
+
+    if (!d->idleTimeout)
+    {
+        d->idleTimer->stop();
+    }
+}
+
+int ExifToolProcess::idleTimeout() const
+{
+    return d->idleTimeout;
+}
+
+void ExifToolProcess::setAutoRestart(bool enable, int maxRetries)
+{
+    d->autoRestart = enable;
+    d->maxRetries  = qMax(0, maxRetries);
+}
+
+bool ExifToolProcess::autoRestart() const
+{
+    return d->autoRestart;
+}
+
+void ExifToolProcess::setHotStandby(bool enable)
+{
+    d->hotStandby = enable;
+
+    if      (!enable)
+    {
+        stopStandby();
+    }
+    else if (isRunning())
+    {
+        startStandby();
+    }
+}
+
+bool ExifToolProcess::hotStandby() const
+{
+    return d->hotStandby;
+}
+
+bool ExifToolProcess::isStandbyReady() const
+{
+    return d->standbyReady;
+}
+
+void ExifToolProcess::setProgram(const QString& etExePath, const QString& perlExePath)
+{
+    if ((etExePath == d->etExePath) && (perlExePath == d->perlExePath))
+    {
+        return;
+    }
+
+    // Check if ExifTool is starting or running
+
+    if (d->process->state() != QProcess::NotRunning)
+    {
+        qWarning() << "ExifToolProcess::setProgram(): ExifTool is already running";
+        return;
+    }
+
+    d->etExePath   = etExePath;
+    d->perlExePath = perlExePath;
+
+    stopStandby();
+}
+
+QString ExifToolProcess::program() const
+{
+    return d->etExePath;
+}
+
+QString ExifToolProcess::perlPath() const
+{
+    return d->perlExePath;
+}
+
+void ExifToolProcess::setCommonArgs(const QByteArrayList& args)
+{
+    if (args == d->commonArgs)
+    {
+        return;
+    }
+
+    // Check if ExifTool is starting or running
+
+    if (d->process->state() != QProcess::NotRunning)
+    {
+        qWarning() << "ExifToolProcess::setCommonArgs(): ExifTool is already running";
+        return;
+    }
+
+    // The {ready} echo is added for the quiet options of a command, not for the common ones.
+
+    d->commonArgs.clear();
+
+    for (const QByteArray& arg : args)
+    {
+        if (ExifToolCommandTemplate::isQuietOption(arg))
+        {
+            qWarning() << "ExifToolProcess::setCommonArgs(): quiet option" << arg << "is not supported";
+            continue;
+        }
+
+        d->commonArgs.append(arg);
+    }
+
+    stopStandby();
+}
+
+QByteArrayList ExifToolProcess::commonArgs() const
+{
+    return d->commonArgs;
+}
+
+void ExifToolProcess::start()
+{
+    // Check if ExifTool is starting or running
+
+    if (d->process->state() != QProcess::NotRunning)
+    {
+        qWarning() << "ExifToolProcess::start(): ExifTool is already running";
+        return;
+    }
+
+    // After a crash or a planned restart, the replayed commands wait in the queue for the new process: keep them.
+
+    if (d->respawnTimer->isActive() || d->restartPending)
+    {
+        return;
+    }
+
+    // Clear queue before start
+
+    d->abortCommands(d->cmdQueue);
+    d->abortCommands(d->cmdInFlight);
+    d->outChannel[QProcess::StandardOutput].streamIds.clear();
+
+    startProcess();
+}
+
+void ExifToolProcess::startProcess()
+{
+    // Check if Exiftool program exists and have execution permissions
+
+    if (!QFile::exists(d->etExePath) ||
+        !(QFile::permissions(d->etExePath) & QFile::ExeUser))
+    {
+        setProcessErrorAndEmit(QProcess::FailedToStart,
+                               QString::fromLatin1("ExifTool does not exists or exec permission is missing"));
+        return;
+    }
+
+    // If perl path is defined, check if Perl program exists and have execution permissions
+
+    if (!d->perlExePath.isEmpty() && (!QFile::exists(d->perlExePath) ||
+        !(QFile::permissions(d->perlExePath) & QFile::ExeUser)))
+    {
+        setProcessErrorAndEmit(QProcess::FailedToStart,
+                               QString::fromLatin1("Perl does not exists or exec permission is missing"));
+        return;
+    }
+
+    // Clear errors
+
+    d->processError         = QProcess::UnknownError;
+    d->errorString.clear();
+
+    // Start ExifTool process
+
+    d->idleTimer->stop();
+    d->respawnTimer->stop();
+    d->idleShutdown         = false;
+    d->restartPending       = false;
+    d->stopRequested        = false;
+    d->writeChannelIsClosed = false;
+
+    // Replace the process by the warm standby one if it is ready: the Perl startup is already paid.
+
+    if (d->standbyReady)
+    {
+        QProcess* const old = d->process;
+        disconnectProcess(d->standby);
+
+        d->process          = d->standby;
+        d->standby          = nullptr;
+        d->standbyReady     = false;
+        d->standbyOutput.clear();
+
+        connectProcess(d->process);
+        retireProcess(old);
+
+        qDebug() << "ExifTool standby process swapped in";
+
+        emit signalStateChanged(QProcess::Running);
+        slotStarted();
+
+        return;
+    }
+
+    QString program;
+    QStringList args;
+    programArgs(program, args);
+
+    d->process->start(program, args, QProcess::ReadWrite);
+}
+
+void ExifToolProcess::programArgs(QString& program, QStringList& args) const
 {
-public:
+    // Prepare command for ExifTool
 
-    struct Command
+    program = d->etExePath;
+    args.clear();
+
+    if (!d->perlExePath.isEmpty())
     {
-        Command()
-          : id(0)
-        {
-        }
+        program = d->perlExePath;
+        args << d->etExePath;
+    }
 
-        int        id;
-        QByteArray argsStr;
-    };
+    //-- Advanced options
 
-public:
+    args << QLatin1String("-stay_open");
+    args << QLatin1String("true");
 
-    explicit Private()
-      : process             (nullptr),
-        cmdRunning          (0),
-        writeChannelIsClosed(true),
-        processError        (QProcess::UnknownError)
+    //-- Other options
+
+    args << QLatin1String("-@");
+    args << QLatin1String("-");
+
+    //-- Session options, added to each command. Must be the last ones.
+
+    if (!d->commonArgs.isEmpty())
     {
-        outAwait[0] = false;
-        outAwait[1] = false;
-        outReady[0] = false;
-        outReady[1] = false;
-    }
+        args << QLatin1String("-common_args");
 
-public:
+        for (const QByteArray& arg : d->commonArgs)
+        {
+            args << QString::fromUtf8(arg);
+        }
+    }
+}
 
-    QString                etExePath;
-    QString                perlExePath;
-    QProcess*              process;
+void ExifToolProcess::startStandby()
+{
+    if (!d->hotStandby || d->standby || d->stopRequested)
+    {
+        return;
+    }
 
-    QElapsedTimer          execTimer;
-    QList<Command>         cmdQueue;
-    int                    cmdRunning;
+    QString program;
+    QStringList args;
+    programArgs(program, args);
 
-    int                    outAwait[2];             ///< [0] StandardOutput | [1] ErrorOutput
-    bool                   outReady[2];             ///< [0] StandardOutput | [1] ErrorOutput
-    QByteArray             outBuff[2];              ///< [0] StandardOutput | [1] ErrorOutput
+    d->standby      = new QProcess(this);
+    d->standbyReady = false;
+    d->standbyOutput.clear();
 
-    bool                   writeChannelIsClosed;
+    QProcess* const standby = d->standby;
 
-    QProcess::ProcessError processError;
-    QString                errorString;
+    // Warm up the process with a trivial command, which loads the Perl modules.
 
-public:
+    connect(standby, &QProcess::started,
+            this, [standby]()
+        {
+            standby->write(QByteArray("-ver\n-execute\n"));
+        }
+    );
 
-    static const int       CMD_ID_MIN  = 1;
-    static const int       CMD_ID_MAX  = 2000000000;
+    connect(standby, &QProcess::readyReadStandardOutput,
+            this, [this, standby]()
+        {
+            d->standbyOutput.append(standby->readAllStandardOutput());
+            standby->readAllStandardError();
 
-    static int             s_nextCmdId;               ///< Unique identifier, even in a multi-instances or multi-thread environment
-    static QMutex          s_cmdIdMutex;
-};
+            if (!d->standbyReady && d->standbyOutput.contains("{ready}"))
+            {
+                qDebug() << "ExifTool standby process ready";
+                d->standbyReady = true;
+                d->standbyOutput.clear();
 
-QMutex ExifToolProcess::Private::s_cmdIdMutex;
-int    ExifToolProcess::Private::s_nextCmdId = ExifToolProcess::Private::CMD_ID_MIN;
+                // A restart may be waiting for the running process to be killed: use the standby now.
 
-ExifToolProcess::ExifToolProcess(QObject* const parent)
-    : QObject(parent),
-      d      (new Private)
-{
-    d->process = new QProcess(this);
-/*
-    d->process->setProcessEnvironment(adjustedEnvironmentForAppImage());
-*/
-    connect(d->process, &QProcess::started,
-            this, &ExifToolProcess::slotStarted);
+                if (d->restartPending && (d->process->state() != QProcess::NotRunning))
+                {
+                    d->restartPending = false;
+                    startProcess();
+                }
+            }
+        }
+    );
 
 #if QT_VERSION >= 0x060000
 
-    connect(d->process, &QProcess::finished,
-            this, &ExifToolProcess::slotFinished);
+    connect(standby, &QProcess::finished,
+            this, [this]()
+        {
+            stopStandby();
+        }
+    );
 
 #else
 
-    connect(d->process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &ExifToolProcess::slotFinished);
+    connect(standby, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this]()
+        {
+            stopStandby();
+        }
+    );
 
 #endif
 
-    connect(d->process, &QProcess::stateChanged,
-            this, &ExifToolProcess::slotStateChanged);
+    standby->start(program, args, QProcess::ReadWrite);
+}
 
-    connect(d->process, &QProcess::errorOccurred,
-            this, &ExifToolProcess::slotErrorOccurred);
+void ExifToolProcess::stopStandby()
+{
+    if (!d->standby)
+    {
+        return;
+    }
 
-    connect(d->process, &QProcess::readyReadStandardOutput,
-            this, &ExifToolProcess::slotReadyReadStandardOutput);
+    QProcess* const standby = d->standby;
+    d->standby              = nullptr;
+    d->standbyReady         = false;
+    d->standbyOutput.clear();
 
-    connect(d->process, &QProcess::readyReadStandardError,
-            this, &ExifToolProcess::slotReadyReadStandardError);
+    retireProcess(standby);
 }
 
-ExifToolProcess::~ExifToolProcess()
+void ExifToolProcess::terminate()
 {
-    delete d;
+    d->restartPending = false;
+    d->stopRequested  = true;
+
+    stopStandby();
+
+    if (d->respawnTimer->isActive())
+    {
+        d->respawnTimer->stop();
+        d->abortCommands(d->cmdQueue);
+    }
+
+    if (d->process->state() == QProcess::Running)
+    {
+        // If process is in running state, close ExifTool normally
+
+        d->abortCommands(d->cmdQueue);
+        d->process->write(QByteArray("-stay_open\nfalse\n"));
+        d->process->closeWriteChannel();
+        d->writeChannelIsClosed = true;
+    }
+    else
+    {
+        // Otherwise, close ExifTool using OS system call
+        // (WM_CLOSE [Windows] or SIGTERM [Unix])
+
+        d->process->terminate();
+    }
 }
 
-void ExifToolProcess::setProgram(const QString& etExePath, const QString& perlExePath)
+void ExifToolProcess::kill()
 {
-    // Check if ExifTool is starting or running
+    d->restartPending = false;
+    d->stopRequested  = true;
 
-    if (d->process->state() != QProcess::NotRunning)
+    stopStandby();
+
+    if (d->respawnTimer->isActive())
     {
-        qWarning() << "ExifToolProcess::setProgram(): ExifTool is already running";
-        return;
+        d->respawnTimer->stop();
+        d->abortCommands(d->cmdQueue);
     }
 
-    d->etExePath   = etExePath;
-    d->perlExePath = perlExePath;
+    d->process->kill();
 }
 
-QString ExifToolProcess::program() const
+bool ExifToolProcess::cancel(int cmdId)
 {
-    return d->etExePath;
+    // Not yet written to ExifTool: just drop it.
+
+    Private::Command queued;
+
+    if (d->cmdQueue.takeCommand(cmdId, queued))
+    {
+        d->updateQueueLevel();
+        d->failCommand(queued, CommandCancelled);
+
+        return true;
+    }
+
+    const int index = d->inFlightIndex(cmdId);
+
+    if (index == -1)
+    {
+        // Merged in an execution with other files: only discard its part of the output.
+
+        for (int i = 0 ; i < d->cmdInFlight.size() ; ++i)
+        {
+            QList<Private::Command>& members = d->cmdInFlight[i].members;
+
+            for (int m = 0 ; m < members.size() ; ++m)
+            {
+                if ((members[m].id == cmdId) && !members[m].cancelled)
+                {
+                    d->failCommand(members[m], CommandCancelled);
+                    members[m].cancelled = true;
+
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    if (d->cmdInFlight[index].cancelled)
+    {
+        return false;
+    }
+
+    if (index == 0)
+    {
+        // Currently executed by ExifTool, which cannot be interrupted: restart the process.
+
+        restartProcess(CommandCancelled);
+
+        return true;
+    }
+
+    // Written to ExifTool but not started: its output will be discarded on completion.
+
+    d->failCommand(d->cmdInFlight[index], CommandCancelled);
+    d->cmdInFlight[index].cancelled = true;
+
+    return true;
 }
 
-void ExifToolProcess::start()
+void ExifToolProcess::restartProcess(CommandError error)
 {
-    // Check if ExifTool is starting or running
+    // Fail the running command, or replay its members after a timeout, and put the commands
+    // written behind it back in the queue.
 
-    if (d->process->state() != QProcess::NotRunning)
+    Private::Command running = d->cmdInFlight.takeFirst();
+
+    while (!d->cmdInFlight.isEmpty())
     {
-        qWarning() << "ExifToolProcess::start(): ExifTool is already running";
+        Private::Command cmd = d->cmdInFlight.takeLast();
+
+        if (!cmd.cancelled)
+        {
+            d->cmdQueue.prepend(cmd);
+        }
+    }
+
+    d->deadlineTimer->stop();
+
+    if ((error == CommandTimedOut) && !running.members.isEmpty())
+    {
+        // One slow file delays all the files merged with it: replay them one by one
+        // with their own timeout, as after a crash. Retries are never merged.
+
+        for (int m = running.members.size() - 1 ; m >= 0 ; --m)
+        {
+            Private::Command member = running.members[m];
+
+            if (!member.cancelled)
+            {
+                member.retries++;
+                d->cmdQueue.prepend(member);
+            }
+        }
+    }
+    else
+    {
+        d->failCommand(running, error);
+    }
+
+    d->metrics.increment(ExifToolMetrics::Restarts);
+
+    qWarning() << "ExifToolProcess: restarting ExifTool process after command" << running.id
+               << "failed with error" << error;
+
+    // The process is started again by slotFinished(), queued commands are sent from slotStarted().
+    // A ready standby process replaces it at once, the old one is killed in the background.
+
+    if (d->standbyReady)
+    {
+        startProcess();
+    }
+    else if (d->process->state() != QProcess::NotRunning)
+    {
+        d->restartPending = true;
+        d->process->kill();
+    }
+    else
+    {
+        startProcess();
+    }
+}
+
+void ExifToolProcess::armDeadline()
+{
+    if (d->cmdInFlight.isEmpty() || (d->cmdInFlight.first().timeout <= 0))
+    {
+        d->deadlineTimer->stop();
+
         return;
     }
 
-    // Check if Exiftool program exists and have execution permissions
+    const Private::Command& running = d->cmdInFlight.first();
 
-    if (!QFile::exists(d->etExePath) ||
-        !(QFile::permissions(d->etExePath) & QFile::ExeUser))
+    d->deadlineTimer->start(qMax((qint64)0, running.timeout - running.execTimer.elapsed()));
+}
+
+void ExifToolProcess::slotDeadlineExceeded()
+{
+    if (d->cmdInFlight.isEmpty())
     {
-        setProcessErrorAndEmit(QProcess::FailedToStart,
-                               QString::fromLatin1("ExifTool does not exists or exec permission is missing"));
         return;
     }
 
-    // If perl path is defined, check if Perl program exists and have execution permissions
+    const Private::Command& running = d->cmdInFlight.first();
 
-    if (!d->perlExePath.isEmpty() && (!QFile::exists(d->perlExePath) ||
-        !(QFile::permissions(d->perlExePath) & QFile::ExeUser)))
+    if ((running.timeout <= 0) || (running.execTimer.elapsed() < running.timeout))
     {
-        setProcessErrorAndEmit(QProcess::FailedToStart,
-                               QString::fromLatin1("Perl does not exists or exec permission is missing"));
+        armDeadline();
+
         return;
     }
 
-    // Prepare command for ExifTool
+    d->metrics.increment(ExifToolMetrics::Timeouts);
+    restartProcess(CommandTimedOut);
+}
 
-    QString program = d->etExePath;
-    QStringList args;
+bool ExifToolProcess::isRunning() const
+{
+    return (d->process->state() == QProcess::Running);
+}
 
-    if (!d->perlExePath.isEmpty())
+bool ExifToolProcess::isBusy() const
+{
+    return !d->cmdInFlight.isEmpty();
+}
+
+bool ExifToolProcess::isIdleShutdown() const
+{
+    return d->idleShutdown;
+}
+
+int ExifToolProcess::queueDepth(CommandPriority priority) const
+{
+    return d->cmdQueue.size(priority);
+}
+
+int ExifToolProcess::queueDepth() const
+{
+    return d->cmdQueue.size();
+}
+
+void ExifToolProcess::setPipelineDepth(int depth)
+{
+    d->pipelineDepth = qMax(1, depth);
+
+    if (isRunning())
     {
-        program = d->perlExePath;
-        args << d->etExePath;
+        execNextCmd();
     }
+}
 
-    //-- Advanced options
+int ExifToolProcess::pipelineDepth() const
+{
+    return d->pipelineDepth;
+}
 
-    args << QLatin1String("-stay_open");
-    args << QLatin1String("true");
+ExifToolMetrics* ExifToolProcess::metrics() const
+{
+    return &d->metrics;
+}
 
-    //-- Other options
+void ExifToolProcess::setQueueLimits(int highWater, int lowWater)
+{
+    d->highWater = qMax(0, highWater);
+    d->lowWater  = (lowWater < 0) ? (d->highWater / 2) : qMin(lowWater, d->highWater);
 
-    args << QLatin1String("-@");
-    args << QLatin1String("-");
+    if (!d->highWater && d->queueFull.loadAcquire())
+    {
+        d->queueFull.storeRelease(0);
 
-    // Clear queue before start
+        emit signalQueueDrained();
+    }
 
-    d->cmdQueue.clear();
-    d->cmdRunning           = 0;
+    d->updateQueueLevel();
+}
 
-    // Clear errors
+int ExifToolProcess::highWaterMark() const
+{
+    return d->highWater;
+}
 
-    d->processError         = QProcess::UnknownError;
-    d->errorString.clear();
+int ExifToolProcess::lowWaterMark() const
+{
+    return d->lowWater;
+}
+
+bool ExifToolProcess::isQueueFull() const
+{
+    return d->queueFull.loadAcquire();
+}
+
+void ExifToolProcess::setRejectWhenFull(bool reject)
+{
+    d->rejectWhenFull = reject;
+}
 
-    // Start ExifTool process
+bool ExifToolProcess::rejectWhenFull() const
+{
+    return d->rejectWhenFull;
+}
 
-    d->writeChannelIsClosed = false;
+void ExifToolProcess::setDeadlineAdmission(bool enable)
+{
+    d->deadlineAdmission = enable;
+}
 
-    d->process->start(program, args, QProcess::ReadWrite);
+bool ExifToolProcess::deadlineAdmission() const
+{
+    return d->deadlineAdmission;
 }
 
-void ExifToolProcess::terminate()
+qint64 ExifToolProcess::estimatedWaitTime(CommandPriority priority) const
 {
-    if (d->process->state() == QProcess::Running)
+    return d->estimatedWaitTime(priority);
+}
+
+bool ExifToolProcess::waitForQueueSpace(int msecs)
+{
+    if (QThread::currentThread() == thread())
     {
-        // If process is in running state, close ExifTool normally
+        // The queue is drained by this thread: waiting would deadlock.
 
-        d->cmdQueue.clear();
-        d->process->write(QByteArray("-stay_open\nfalse\n"));
-        d->process->closeWriteChannel();
-        d->writeChannelIsClosed = true;
+        return !d->mustWaitForSpace();
     }
-    else
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutexLocker lock(&d->spaceMutex);
+    d->spaceWaiters.ref();
+
+    bool ok = true;
+
+    while (d->mustWaitForSpace())
     {
-        // Otherwise, close ExifTool using OS system call
-        // (WM_CLOSE [Windows] or SIGTERM [Unix])
+        const qint64 remaining = (msecs < 0) ? -1 : (msecs - timer.elapsed());
 
-        d->process->terminate();
+        if ((msecs >= 0) && (remaining <= 0))
+        {
+            ok = false;
+            break;
+        }
+
+        // Also wake up periodically: the owner thread only signals when it drains the queue.
+
+        d->spaceAvailable.wait(&d->spaceMutex, (remaining < 0) ? 100UL : (unsigned long)qMin(remaining, (qint64)100));
     }
-}
 
-void ExifToolProcess::kill()
-{
-    d->process->kill();
+    d->spaceWaiters.deref();
+
+    return ok;
 }
 
-bool ExifToolProcess::isRunning() const
+void ExifToolProcess::setMaxCoalescedFiles(int max)
 {
-    return (d->process->state() == QProcess::Running);
+    d->maxCoalescedFiles = qMax(1, max);
 }
 
-bool ExifToolProcess::isBusy() const
+int ExifToolProcess::maxCoalescedFiles() const
 {
-    return (d->cmdRunning ? true : false);
+    return d->maxCoalescedFiles;
 }
 
 qint64 ExifToolProcess::processId() const
@@ -295,75 +1619,210 @@ bool ExifToolProcess::waitForFinished(int msecs) const
     return d->process->waitForFinished(msecs);
 }
 
-int ExifToolProcess::command(const QByteArrayList& args)
+int ExifToolProcess::command(const QByteArrayList& args, CommandFlags flags, int timeout, CommandPriority priority)
 {
-    if ((d->process->state() != QProcess::Running) ||
-        d->writeChannelIsClosed                    ||
-        args.isEmpty())
+    if ((flags & CoalesceFiles) && !args.isEmpty())
     {
-        qWarning() << "ExifToolProcess::command(): cannot process command with ExifTool" << args;
-        return 0;
+        // The file name is the last argument, and the only one which differs between merged commands.
+
+        return command(ExifToolCommandTemplate(args.mid(0, args.size() - 1)), args.last(),
+                       flags, timeout, priority);
     }
 
-    // ThreadSafe incrementation of d->nextCmdId
+    return command(ExifToolCommandTemplate(args), QByteArray(), flags, timeout, priority);
+}
 
-    Private::s_cmdIdMutex.lock();
-    const int cmdId = Private::s_nextCmdId;
+int ExifToolProcess::command(const ExifToolCommandTemplate& cmdTemplate,
+                             const QByteArray& file,
+                             CommandFlags flags,
+                             int timeout,
+                             CommandPriority priority)
+{
+    const bool isEmpty = (cmdTemplate.isEmpty() && file.isEmpty());
 
-    if (Private::s_nextCmdId++ >= Private::CMD_ID_MAX)
+    if (d->idleShutdown && !isEmpty)
     {
-        Private::s_nextCmdId = Private::CMD_ID_MIN;
-    }
+        // The process was closed after the idle timeout: start it again on demand. If it is still
+        // exiting, it is started when it is finished, see slotFinished(), and the command waits in the queue.
 
-    Private::s_cmdIdMutex.unlock();
-
-    // String representation of d->cmdId with leading zero -> constant size: 10 char
-
-    const QByteArray cmdIdStr = QByteArray::number(cmdId).rightJustified(10, '0');
+        if (d->process->state() == QProcess::NotRunning)
+        {
+            start();
+        }
+        else
+        {
+            d->restartPending = true;
+        }
+    }
 
-    // Build command string from args
+    // Commands sent while a crashed process waits to be respawned, or while the process
+    // is restarted, are queued with the replayed ones.
 
-    QByteArray cmdStr;
+    const bool restarting = (d->respawnTimer->isActive() || d->restartPending);
 
-    for (const QByteArray& arg : args)
+    if ((((d->process->state() != QProcess::Running)  &&
+          (d->process->state() != QProcess::Starting)) && !restarting) ||
+        (d->writeChannelIsClosed && !restarting)                        ||
+        isEmpty)
     {
-        cmdStr.append(arg + '\n');
+        qWarning() << "ExifToolProcess::command(): cannot process command with ExifTool"
+                   << cmdTemplate.options() << file;
+        return 0;
     }
 
-    //-- Advanced options
+    // Admission control
 
-    cmdStr.append(QByteArray("-echo1\n{await") + cmdIdStr + QByteArray("}\n"));     // Echo text to stdout before processing is complete
-    cmdStr.append(QByteArray("-echo2\n{await") + cmdIdStr + QByteArray("}\n"));     // Echo text to stderr before processing is complete
+    d->lastRejected = false;
 
-    if (cmdStr.contains(QByteArray("-q"))               ||
-        cmdStr.toLower().contains(QByteArray("-quiet")) ||
-        cmdStr.contains(QByteArray("-T"))               ||
-        cmdStr.toLower().contains(QByteArray("-table")))
+    if (d->rejectWhenFull && d->highWater && (d->cmdQueue.size() >= d->highWater))
     {
-        cmdStr.append(QByteArray("-echo3\n{ready}\n"));                 // Echo text to stdout after processing is complete
+        qWarning() << "ExifToolProcess::command(): queue is full, command rejected";
+        d->lastRejected = true;
+
+        return 0;
     }
 
-    cmdStr.append(QByteArray("-echo4\n{ready}\n"));                     // Echo text to stderr after processing is complete
-    cmdStr.append(QByteArray("-execute\n"));                            // Execute command and echo {ready} to stdout after processing is complete
+    if (d->deadlineAdmission && (timeout > 0) && (d->estimatedWaitTime(priority) > timeout))
+    {
+        qWarning() << "ExifToolProcess::command(): command cannot start within its timeout of"
+                   << timeout << "ms, rejected";
+        d->lastRejected = true;
+
+        return 0;
+    }
 
-    // TODO: if -binary user, {ready} can not be present in the new line
+    const int cmdId = nextCmdId();
 
     // Add command to queue
 
     Private::Command command;
-    command.id      = cmdId;
-    command.argsStr = cmdStr;
+    command.id       = cmdId;
+    command.flags    = flags;
+    command.timeout  = qMax(0, timeout);
+    command.priority = priority;
+    command.argsStr  = cmdTemplate.serialize(cmdId, file);
+
+    if (flags & CoalesceFiles)
+    {
+        command.cmdTemplate = cmdTemplate;
+        command.file        = file;
+    }
+
+    command.queueTimer.start();
     d->cmdQueue.append(command);
 
+    if (flags & StreamOutput)
+    {
+        d->outChannel[QProcess::StandardOutput].streamIds.insert(cmdId);
+    }
+
     // Exec cmd queue
 
+    d->idleTimer->stop();
+
     execNextCmd();
+    d->updateQueueLevel();
+
+    return cmdId;
+}
+
+int ExifToolProcess::command(const ExifToolCommandTemplate& cmdTemplate,
+                             const QByteArrayList& files,
+                             CommandFlags flags,
+                             int timeout,
+                             CommandPriority priority)
+{
+    if (files.size() <= 1)
+    {
+        return command(cmdTemplate, files.value(0), flags, timeout, priority);
+    }
+
+    return command(ExifToolCommandTemplate(cmdTemplate.options() + files), QByteArray(),
+                   flags & ~CommandFlags(CoalesceFiles), timeout, priority);
+}
+
+QFuture<ExifToolProcess::CommandResult> ExifToolProcess::submit(const QByteArrayList& args, CommandPriority priority)
+{
+    Private::Submission* const node = new Private::Submission;
+    node->args                      = args;
+    node->priority                  = priority;
+    node->promise.reportStarted();
+    QFuture<CommandResult> future   = node->promise.future();
+
+    d->submitted.ref();
+    d->pushSubmission(node);
+
+    // Wake up the owner thread only once for all submissions arriving before it drains the queue.
+
+    if (d->drainScheduled.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(this, "slotDrainSubmissions", Qt::QueuedConnection);
+    }
+
+    return future;
+}
+
+void ExifToolProcess::slotDrainSubmissions()
+{
+    d->drainScheduled.storeRelease(0);
+
+    if (d->process->state() == QProcess::NotRunning)
+    {
+        start();
+    }
+
+    while (Private::Submission* const node = d->popSubmission())
+    {
+        d->submitted.deref();
+        const int cmdId = command(node->args, NoCommandFlags, 0, node->priority);
+
+        if (cmdId)
+        {
+            d->promises.insert(cmdId, node->promise);
+        }
+        else
+        {
+            CommandResult result;
+            result.failure = d->lastRejected ? CommandRejected : CommandDropped;
+            node->promise.reportResult(result);
+            node->promise.reportFinished();
+        }
+
+        delete node;
+    }
+
+    d->updateQueueLevel();
+
+    // A producer was still linking its node: come back later to take it.
+
+    if (d->hasSubmissions() && d->drainScheduled.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(this, "slotDrainSubmissions", Qt::QueuedConnection);
+    }
+}
+
+int ExifToolProcess::nextCmdId()
+{
+    // ThreadSafe incrementation of d->nextCmdId
+
+    QMutexLocker lock(&Private::s_cmdIdMutex);
+    const int cmdId = Private::s_nextCmdId;
+
+    if (Private::s_nextCmdId++ >= Private::CMD_ID_MAX)
+    {
+        Private::s_nextCmdId = Private::CMD_ID_MIN;
+    }
 
     return cmdId;
 }
 
 void ExifToolProcess::execNextCmd()
 {
+    if ((d->process->state() == QProcess::Starting) || d->respawnTimer->isActive() || d->restartPending)
+    {
+        return;     // Queue will be processed by slotStarted().
+    }
+
     if ((d->process->state() != QProcess::Running) ||
         d->writeChannelIsClosed)
     {
@@ -371,47 +1830,180 @@ void ExifToolProcess::execNextCmd()
         return;
     }
 
-    if (d->cmdRunning || d->cmdQueue.isEmpty())
+    if (d->cmdInFlight.isEmpty() && !d->cmdQueue.isEmpty())
     {
-        return;
-    }
+        // Clear QProcess buffers
 
-    // Clear QProcess buffers
+        d->process->readAllStandardOutput();
+        d->process->readAllStandardError();
 
-    d->process->readAllStandardOutput();
-    d->process->readAllStandardError();
+        // Clear internal buffers
 
-    // Clear internal buffers
+        d->outChannel[0].clear();
+        d->outChannel[1].clear();
+    }
 
-    d->outBuff[0]            = QByteArray();
-    d->outBuff[1]            = QByteArray();
-    d->outAwait[0]           = false;
-    d->outAwait[1]           = false;
-    d->outReady[0]           = false;
-    d->outReady[1]           = false;
+    // Keep up to pipelineDepth commands written ahead. ExifTool reads them as a stream
+    // and processes them in order, replies are matched with the echoed command ids.
 
-    // Exec Command
+    while ((d->cmdInFlight.size() < d->pipelineDepth) && !d->cmdQueue.isEmpty())
+    {
+        Private::Command command = d->cmdQueue.takeNext();
+        d->coalesce(command);
+        d->metrics.record(ExifToolMetrics::QueueWait, command.queueTimer.nsecsElapsed() / 1000);
+        command.execTimer.start();
+        d->cmdInFlight.append(command);
 
-    d->execTimer.start();
+        d->process->write(command.argsStr);
 
-    Private::Command command = d->cmdQueue.takeFirst();
-    d->cmdRunning            = command.id;
+        if (d->cmdInFlight.size() == 1)
+        {
+            armDeadline();
+        }
+    }
 
-    d->process->write(command.argsStr);
+    d->updateQueueLevel();
 }
 
 void ExifToolProcess::slotStarted()
 {
     qDebug() << "ExifTool process started";
     emit signalStarted();
+
+    startStandby();
+
+    if (!d->cmdQueue.isEmpty())
+    {
+        execNextCmd();
+    }
 }
 
 void ExifToolProcess::slotFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     qDebug() << "ExifTool process finished" << exitCode << exitStatus;
-    d->cmdRunning = 0;
+    d->idleTimer->stop();
+    d->deadlineTimer->stop();
+
+    const bool respawn = d->autoRestart && !d->stopRequested && !d->restartPending;
+
+    if (respawn)
+    {
+        replayInFlight();
+    }
+    else
+    {
+        d->abortCommands(d->cmdInFlight);
+    }
+
+    // A process killed to be restarted is not seen as finished, as when it is replaced by the standby.
+
+    if (d->restartPending)
+    {
+        startProcess();
+
+        return;
+    }
 
     emit signalFinished(exitCode, exitStatus);
+
+    if (respawn)
+    {
+        if (d->respawnCount < Private::RESPAWN_MAX_ATTEMPTS)
+        {
+            qWarning() << "ExifTool process exited unexpectedly, restarting it in" << d->respawnDelay << "ms";
+
+            d->respawnTimer->start(d->respawnDelay);
+            d->respawnCount++;
+            d->metrics.increment(ExifToolMetrics::Restarts);
+            d->respawnDelay = qMin(d->respawnDelay * 2, (int)Private::RESPAWN_MAX_DELAY);
+
+            return;
+        }
+
+        qCritical() << "ExifTool process exited" << d->respawnCount << "times in a row: giving up";
+
+        d->abortCommands(d->cmdQueue, CommandCrashed);
+    }
+    else
+    {
+        d->abortCommands(d->cmdQueue);
+    }
+
+    // The shared instance is not used anymore and is now stopped: release it.
+
+    QMutexLocker lock(&Private::s_sharedMutex);
+
+    if ((this == Private::s_sharedInstance) && (Private::s_sharedRefs <= 0))
+    {
+        Private::s_sharedInstance = nullptr;
+        deleteLater();
+    }
+}
+
+void ExifToolProcess::replayInFlight()
+{
+    // The first in-flight command was executed when the process died, and may be the cause of the crash:
+    // replay it only a limited number of times. The other ones were not started yet.
+
+    QList<Private::Command> replay;
+    const QList<Private::Command> inFlight = d->cmdInFlight;
+    d->cmdInFlight.clear();
+
+    for (int i = 0 ; i < inFlight.size() ; ++i)
+    {
+        Private::Command cmd = inFlight[i];
+
+        if (cmd.cancelled)
+        {
+            continue;
+        }
+
+        if ((i == 0) && !cmd.members.isEmpty())
+        {
+            // One of the merged files may be the cause: replay them one by one, retries are never merged.
+
+            for (Private::Command member : cmd.members)
+            {
+                if (member.cancelled)
+                {
+                    continue;
+                }
+
+                member.retries++;
+                replay << member;
+            }
+
+            continue;
+        }
+
+        if (i == 0)
+        {
+            if (cmd.retries >= d->maxRetries)
+            {
+                qWarning() << "ExifToolProcess: giving up command" << cmd.id << "after" << cmd.retries << "retries";
+                d->failCommand(cmd, CommandCrashed);
+
+                continue;
+            }
+
+            cmd.retries++;
+        }
+
+        replay << cmd;
+    }
+
+    for (int i = replay.size() - 1 ; i >= 0 ; --i)
+    {
+        d->cmdQueue.prepend(replay[i]);
+    }
+}
+
+void ExifToolProcess::slotRespawn()
+{
+    if ((d->process->state() == QProcess::NotRunning) && !d->stopRequested)
+    {
+        startProcess();
+    }
 }
 
 void ExifToolProcess::slotStateChanged(QProcess::ProcessState newState)
@@ -436,77 +2028,159 @@ void ExifToolProcess::slotReadyReadStandardError()
 
 void ExifToolProcess::readOutput(const QProcess::ProcessChannel channel)
 {
+    // Read all available bytes at once, directly at the end of the channel buffer.
+
+    ExifToolOutputFramer& output   = d->outChannel[channel];
     d->process->setReadChannel(channel);
+    const qint64 available         = d->process->bytesAvailable();
 
-    while (d->process->canReadLine() && !d->outReady[channel])
+    if (available > 0)
     {
-        QByteArray line = d->process->readLine();
+        const int oldSize = output.buffer.size();
+        output.buffer.resize(oldSize + (int)available);
+        const qint64 size = d->process->read(output.buffer.data() + oldSize, available);
+        output.buffer.resize(oldSize + (int)qMax(size, (qint64)0));
+
+        d->metrics.increment((channel == QProcess::StandardOutput) ? ExifToolMetrics::StdOutBytes
+                                                                   : ExifToolMetrics::StdErrBytes,
+                             qMax(size, (qint64)0));
+    }
 
-        if (line.endsWith(QByteArray("\r\n")))
-        {
-            line.remove(line.size() - 2, 1); // Remove '\r' character
-        }
-/*
-        qDebug() << channel << line;
-*/
-        if (!d->outAwait[channel])
+    output.scan();
+
+    // Time to first byte of the running command.
+
+    if (!d->cmdInFlight.isEmpty() && !d->cmdInFlight.first().answered &&
+        (d->outChannel[QProcess::StandardOutput].hasOutput(d->cmdInFlight.first().id) ||
+         d->outChannel[QProcess::StandardError].hasOutput(d->cmdInFlight.first().id)))
+    {
+        d->cmdInFlight.first().answered = true;
+        d->metrics.record(ExifToolMetrics::TimeToFirstByte, d->cmdInFlight.first().execTimer.nsecsElapsed() / 1000);
+    }
+
+    // Deliver payload chunks of streamed commands as they arrive.
+
+    while (!output.chunks.isEmpty())
+    {
+        const QPair<int, QByteArray> chunk = output.chunks.takeFirst();
+
+        emit signalCmdData(chunk.first, chunk.second);
+    }
+
+    // Complete in-flight commands in execution order, as soon as outputChannel and errorChannel are both ready
+
+    bool completed = false;
+
+    while (!d->cmdInFlight.isEmpty())
+    {
+        const int cmdId = d->cmdInFlight.first().id;
+
+        if (!(d->outChannel[QProcess::StandardOutput].done.contains(cmdId) &&
+              d->outChannel[QProcess::StandardError].done.contains(cmdId)))
         {
-            if (line.startsWith(QByteArray("{await")) && line.endsWith(QByteArray("}\n")))
+            // ExifTool executes commands in order: a later command completed on a channel
+            // while this one did not means that the channels are out of sync.
+
+            if (
+                !d->hasOtherOutputs(QProcess::StandardOutput, cmdId) &&
+                !d->hasOtherOutputs(QProcess::StandardError,  cmdId)
+               )
             {
-                d->outAwait[channel] = line.mid(6, line.size() - 8).toInt();
+                break;
             }
 
+            qCritical() << "ExifToolProcess::readOutput: Sync error between CmdID("
+                                               << cmdId
+                                               << "), outChannel("
+                                               << d->outChannel[QProcess::StandardOutput].done.keys()
+                                               << ") and errChannel("
+                                               << d->outChannel[QProcess::StandardError].done.keys()
+                                               << ")";
+
+            d->outChannel[QProcess::StandardOutput].done.remove(cmdId);
+            d->outChannel[QProcess::StandardError].done.remove(cmdId);
+
+            d->metrics.increment(ExifToolMetrics::SyncErrors);
+            d->failCommand(d->cmdInFlight.takeFirst(), CommandDropped);
+            armDeadline();
+            completed = true;
+
             continue;
         }
 
-        d->outBuff[channel] += line;
+        Private::Command command = d->cmdInFlight.takeFirst();
+        const QByteArray out     = d->outChannel[QProcess::StandardOutput].done.take(cmdId);
+        const QByteArray err     = d->outChannel[QProcess::StandardError].done.take(cmdId);
+        d->outChannel[QProcess::StandardOutput].streamIds.remove(cmdId);
 
-        if (line.endsWith(QByteArray("{ready}\n")))
-        {
-            d->outBuff[channel].chop(8);
-            d->outReady[channel] = true;
+        // The next command was waiting behind this one in ExifTool: its execution starts now.
 
-            break;
+        if (!d->cmdInFlight.isEmpty())
+        {
+            d->cmdInFlight.first().execTimer.start();
         }
+
+        armDeadline();
+        completed       = true;
+        d->respawnCount = 0;
+        d->respawnDelay = Private::RESPAWN_MIN_DELAY;
+
+        qDebug() << "ExifToolProcess::readOutput(): ExifTool command completed with elapsed time:"
+                                        << command.execTimer.elapsed();
+
+        d->metrics.record(ExifToolMetrics::Execution, command.execTimer.nsecsElapsed() / 1000);
+
+        // Exponential moving average, per file for merged commands.
+
+        const double execTime = (double)command.execTimer.elapsed() / qMax(1, command.members.size());
+        d->avgExecTime        = (d->avgExecTime == 0.0) ? execTime : (0.9 * d->avgExecTime + 0.1 * execTime);
+
+        d->completeCommand(command, command.execTimer.elapsed(), out, err);
     }
 
-    // Check if outputChannel and errorChannel are both ready
+    // Drop outputs which do not match any in-flight command (ex: process restarted).
 
-    if (!(d->outReady[QProcess::StandardOutput] &&
-        d->outReady[QProcess::StandardError]))
+    for (int c = 0 ; c < 2 ; ++c)
     {
-/*
-        qWarning() << "ExifToolProcess::readOutput(): ExifTool read channels are not ready";
-*/
-        return;
+        QHash<int, QByteArray>::iterator it = d->outChannel[c].done.begin();
+
+        while (it != d->outChannel[c].done.end())
+        {
+            if (d->inFlightIndex(it.key()) == -1)
+            {
+                qCritical() << "ExifToolProcess::readOutput: Sync error, unexpected output for CmdID(" << it.key() << ")";
+                d->metrics.increment(ExifToolMetrics::SyncErrors);
+                it = d->outChannel[c].done.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
     }
 
-    if (
-        (d->cmdRunning != d->outAwait[QProcess::StandardOutput]) ||
-        (d->cmdRunning != d->outAwait[QProcess::StandardError])
-       )
+    if (completed)
     {
-        qCritical() << "ExifToolProcess::readOutput: Sync error between CmdID("
-                                           << d->cmdRunning
-                                           << "), outChannel("
-                                           << d->outAwait[0]
-                                           << ") and errChannel("
-                                           << d->outAwait[1]
-                                           << ")";
+        execNextCmd();     // Exec next commands
+
+        if (d->idleTimeout && d->cmdInFlight.isEmpty() && d->cmdQueue.isEmpty())
+        {
+            d->idleTimer->start(d->idleTimeout);
+        }
     }
-    else
+}
+
+void ExifToolProcess::slotIdleTimeout()
+{
+    if (isBusy() || !d->cmdQueue.isEmpty() || (d->process->state() != QProcess::Running))
     {
-        qDebug() << "ExifToolProcess::readOutput(): ExifTool command completed with elapsed time:"
-                                        << d->execTimer.elapsed();
-        emit signalCmdCompleted(d->cmdRunning,
-                                d->execTimer.elapsed(),
-                                d->outBuff[QProcess::StandardOutput],
-                                d->outBuff[QProcess::StandardError]);
+        return;
     }
 
-    d->cmdRunning = 0; // No command is running
+    qDebug() << "ExifTool process idle since" << d->idleTimeout << "ms: closing it";
 
-    execNextCmd();     // Exec next command
+    terminate();
+    d->idleShutdown = true;
 }
 
 void ExifToolProcess::setProcessErrorAndEmit(QProcess::ProcessError error, const QString& description)
@@ -515,6 +2189,12 @@ void ExifToolProcess::setProcessErrorAndEmit(QProcess::ProcessError error, const
     d->errorString  = description;
 
     emit signalErrorOccurred(error);
+
+    if (error == QProcess::FailedToStart)
+    {
+        d->restartPending = false;
+        d->abortCommands(d->cmdQueue);
+    }
 }
 
 } // namespace Digikam
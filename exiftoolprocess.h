@@ -31,8 +31,15 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QProcess>
 #include <QMutex>
+#include <QFuture>
+
+// Local includes
+
+#include "exiftoolcommandtemplate.h"
+#include "exiftoolmetrics.h"
 
 namespace Digikam
 {
@@ -41,6 +48,81 @@ class ExifToolProcess : public QObject
 {
     Q_OBJECT
 
+public:
+
+    /**
+     * Options of a command sent to ExifTool.
+     */
+    enum CommandFlag
+    {
+        NoCommandFlags = 0x00,
+
+        /**
+         * Deliver the standard output with signalCmdData() while the command runs,
+         * instead of accumulating it in memory. signalCmdCompleted() is emitted at
+         * the end with an empty output channel.
+         */
+        StreamOutput   = 0x01,
+
+        /**
+         * The last argument is a file name, and the output is requested in JSON format with -json.
+         * Pending commands with this flag, the same priority and the same other arguments are merged
+         * in one ExifTool execution with a list of files. The JSON array is split back per SourceFile,
+         * and each command completes on its own with the object of its file.
+         */
+        CoalesceFiles  = 0x02
+    };
+    Q_DECLARE_FLAGS(CommandFlags, CommandFlag)
+
+    /**
+     * Reasons reported when a command does not complete.
+     */
+    enum CommandError
+    {
+        NoCommandError = 0,
+        CommandDropped,                 ///< Process stopped or failed to start, or output out of sync.
+        CommandCancelled,               ///< Cancelled with cancel().
+        CommandTimedOut,                ///< Execution exceeded the command timeout, the process was restarted.
+        CommandCrashed,                 ///< Process crashed while running the command, and the retries are exhausted.
+        CommandRejected                 ///< Refused by the admission control: queue full or timeout unreachable.
+    };
+    Q_ENUM(CommandError)
+
+    /**
+     * Scheduling classes of commands. Pending commands of a higher class are sent first,
+     * with aging so that lower classes still progress.
+     */
+    enum CommandPriority
+    {
+        InteractivePriority = 0,        ///< Request waited by the user.
+        NormalPriority,
+        BackgroundPriority              ///< Bulk work, such as a collection scan.
+    };
+    Q_ENUM(CommandPriority)
+
+    /**
+     * Result of a command sent with submit().
+     */
+    class CommandResult
+    {
+    public:
+
+        CommandResult()
+          : cmdId    (0),
+            execTime (0),
+            completed(false),
+            failure  (CommandDropped)
+        {
+        }
+
+        int          cmdId;
+        int          execTime;
+        bool         completed;         ///< False if the command could not be sent or was dropped.
+        CommandError failure;           ///< Reason why the command did not complete.
+        QByteArray   output;            ///< Standard output channel.
+        QByteArray   error;             ///< Standard error channel.
+    };
+
 public:
 
     /**
@@ -54,6 +136,19 @@ public:
      */
     ~ExifToolProcess();
 
+    /**
+     * Return the process-wide ExifToolProcess instance, creating it on first call.
+     * The instance is shared by all callers to avoid paying the ExifTool startup
+     * on each use: start it only if it is not running yet. Its process is closed
+     * after the idle timeout, and started again on the next command. It writes up to 4 commands
+     * ahead of the running one: a higher priority command can wait behind them.
+     * Each call must be balanced with releaseSharedInstance(), the instance
+     * is destroyed when it is not referenced anymore and its process is stopped.
+     * The instance must be used from the thread which created it.
+     */
+    static ExifToolProcess* acquireSharedInstance();
+    static void             releaseSharedInstance();
+
 public:
 
     /**
@@ -62,7 +157,16 @@ public:
     void setProgram(const QString& etExePath,
                     const QString& perlExePath = QString());
 
-    QString program() const;
+    QString program()   const;
+    QString perlPath()  const;
+
+    /**
+     * Options shared by all commands of the session, given to ExifTool with -common_args
+     * so they are not written to the pipe with each command. This function must be called before start().
+     * Quiet options (-q, -T) are dropped: they would hide the end of each command from the session.
+     */
+    void           setCommonArgs(const QByteArrayList& args);
+    QByteArrayList commonArgs()     const;
 
     /**
      * Starts exiftool in a new process.
@@ -95,6 +199,116 @@ public:
      */
     bool                   isBusy()         const;
 
+    /**
+     * Return true if the process was closed after the idle timeout: the next command() starts it again.
+     */
+    bool                   isIdleShutdown() const;
+
+    /**
+     * Return the number of commands waiting to be sent to ExifTool, for one priority class or for all.
+     */
+    int                    queueDepth(CommandPriority priority) const;
+    int                    queueDepth()     const;
+
+    /**
+     * Set the number of commands which can be written to exiftool before the previous ones
+     * are completed. ExifTool reads commands as a stream, so a depth greater than 1 removes
+     * the pipe round-trip between commands. Replies are matched to commands with the echoed
+     * command identifier. Default is 1: a command is written when the previous one is completed.
+     * The shared instance uses a depth of 4, see acquireSharedInstance().
+     */
+    void                   setPipelineDepth(int depth);
+    int                    pipelineDepth()  const;
+
+    /**
+     * Bound the command queue. When the queue reaches highWater commands, it is full and
+     * signalQueueFull() is emitted. When it goes down to lowWater commands, signalQueueDrained()
+     * is emitted. A negative lowWater uses the half of highWater. highWater 0 removes the bound,
+     * which is the default. Producers should pause between these signals, or wait with
+     * waitForQueueSpace() from other threads.
+     */
+    void                   setQueueLimits(int highWater, int lowWater = -1);
+    int                    highWaterMark()  const;
+    int                    lowWaterMark()   const;
+    bool                   isQueueFull()    const;
+
+    /**
+     * When enabled, command() fails and returns 0 while the queue has highWater commands or more,
+     * and submit() results fail with CommandRejected. Default is disabled: the water marks are only advisory.
+     */
+    void                   setRejectWhenFull(bool reject);
+    bool                   rejectWhenFull() const;
+
+    /**
+     * When enabled, a command with a timeout is refused if it cannot start before its timeout
+     * expires, from estimatedWaitTime(). Default is disabled.
+     */
+    void                   setDeadlineAdmission(bool enable);
+    bool                   deadlineAdmission() const;
+
+    /**
+     * Return the estimated delay in milliseconds before a new command of this priority starts,
+     * from the commands waiting before it and the mean execution time of the previous ones.
+     */
+    qint64                 estimatedWaitTime(CommandPriority priority = NormalPriority) const;
+
+    /**
+     * Block the calling thread until the queue is not full, or until msecs milliseconds
+     * have passed. A negative msecs waits forever. Submissions which are not yet drained
+     * count in the queue size. To be used by producer threads before submit().
+     * Called from the thread owning this object, it does not wait.
+     * Return false if the queue is still full.
+     */
+    bool                   waitForQueueSpace(int msecs = -1);
+
+    /**
+     * Return the latency histograms and counters of this instance, owned by it.
+     * Snapshots can be taken from any thread.
+     */
+    ExifToolMetrics*       metrics()        const;
+
+    /**
+     * Set the maximum number of CoalesceFiles commands merged in one ExifTool execution.
+     * ExifTool amortizes its per-execution overhead over the file list. Default is 32,
+     * 1 disables the merging.
+     */
+    void                   setMaxCoalescedFiles(int max);
+    int                    maxCoalescedFiles() const;
+
+    /**
+     * Close the ExifTool process when no command was sent during msecs milliseconds.
+     * The next command() starts the process again, without waiting for the old one to exit:
+     * the command is queued until the new process is started. 0 disables the timeout, which is the default.
+     */
+    void                   setIdleTimeout(int msecs);
+    int                    idleTimeout()    const;
+
+    /**
+     * When enabled, the process is started again if it exits without terminate() or kill(),
+     * after a delay growing exponentially with consecutive crashes. Queued commands are replayed.
+     * The command running during the crash is replayed at most maxRetries times, then fails
+     * with CommandCrashed, so a file crashing ExifTool cannot cause a crash loop.
+     * If the process keeps exiting, all queued commands fail with CommandCrashed.
+     * Default is disabled.
+     */
+    void                   setAutoRestart(bool enable, int maxRetries = 1);
+    bool                   autoRestart()    const;
+
+    /**
+     * When enabled, a second ExifTool process is started with the active one and warmed up
+     * with a trivial command, which loads the Perl modules. When the active process is restarted
+     * after a timeout or a cancellation, or respawned after a crash, the standby one replaces it
+     * at once, and a new standby process is prepared. The standby process is stopped with
+     * terminate(), kill() and the idle timeout. Default is disabled, except for the shared instance.
+     */
+    void                   setHotStandby(bool enable);
+    bool                   hotStandby()     const;
+
+    /**
+     * Return true if a warm standby process is ready to replace the active one.
+     */
+    bool                   isStandbyReady() const;
+
     /**
      * Returns the native process identifier for the running process, if available.
      * If no process is currently running, 0 is returned.
@@ -136,14 +350,76 @@ public:
     bool waitForFinished(int msecs = 30000) const;
 
     /**
-     * Send a command to exiftool process
+     * Send a command to exiftool process, queued according to its priority class.
+     * If timeout is greater than 0, the command fails with CommandTimedOut when its
+     * execution takes more than timeout milliseconds: the process is then killed and restarted,
+     * and the next commands resume. Commands merged with CoalesceFiles share the sum of their
+     * timeouts, and are replayed one by one when it is exceeded.
      * Return 0: ExitTool not running, write channel is closed or args is empty
      */
-    int command(const QByteArrayList& args);
+    int command(const QByteArrayList& args,
+                CommandFlags flags = NoCommandFlags,
+                int timeout = 0,
+                CommandPriority priority = NormalPriority);
+
+    /**
+     * Send a command built from a template, with an optional file name appended to its options.
+     * The template is serialized once: only the file name and the command identifier are
+     * spliced in, which is the cheapest way to send the same command for many files.
+     */
+    int command(const ExifToolCommandTemplate& cmdTemplate,
+                const QByteArray& file,
+                CommandFlags flags = NoCommandFlags,
+                int timeout = 0,
+                CommandPriority priority = NormalPriority);
+
+    /**
+     * Send a command built from a template for a list of files, executed at once by ExifTool.
+     * Such a command is never merged with other ones: CoalesceFiles is ignored with more than one file.
+     */
+    int command(const ExifToolCommandTemplate& cmdTemplate,
+                const QByteArrayList& files,
+                CommandFlags flags = NoCommandFlags,
+                int timeout = 0,
+                CommandPriority priority = NormalPriority);
+
+    /**
+     * Cancel a command. A pending command is removed from the queue. The command being
+     * executed by ExifTool cannot be interrupted: the process is restarted.
+     * signalCmdFailed() is emitted with CommandCancelled.
+     * Return false if the command is unknown or already completed.
+     */
+    bool cancel(int cmdId);
+
+    /**
+     * Send a command to exiftool process from any thread, concurrently with other threads.
+     * Commands are pushed to a lock-free queue drained by the thread which owns this object,
+     * which starts the process if necessary. The returned future holds the command result.
+     * Note: waiting for the future from the owner thread without processing events will deadlock.
+     */
+    QFuture<CommandResult> submit(const QByteArrayList& args,
+                                  CommandPriority priority = NormalPriority);
+
+    /**
+     * Return a new command identifier, unique even in a multi-instances or multi-thread environment.
+     * Identifiers are shared with command(), so they can be used to track commands dispatched
+     * through a higher level container such as ExifToolPool.
+     */
+    static int nextCmdId();
 
 private:
 
     void execNextCmd();
+    void startProcess();
+    void programArgs(QString& program, QStringList& args) const;
+    void startStandby();
+    void stopStandby();
+    void connectProcess(QProcess* const process);
+    void disconnectProcess(QProcess* const process);
+    void retireProcess(QProcess* const process);
+    void restartProcess(CommandError error);
+    void replayInFlight();
+    void armDeadline();
 
 private Q_SLOTS:
 
@@ -154,6 +430,10 @@ private Q_SLOTS:
     void slotReadyReadStandardError();
     void slotFinished(int exitCode,
                       QProcess::ExitStatus exitStatus);
+    void slotIdleTimeout();
+    void slotDrainSubmissions();
+    void slotDeadlineExceeded();
+    void slotRespawn();
 
 private:
 
@@ -166,6 +446,11 @@ Q_SIGNALS:
     void signalStarted();
     void signalStateChanged(QProcess::ProcessState newState);
     void signalErrorOccurred(QProcess::ProcessError error);
+
+    /**
+     * Emitted when the process exits. Not emitted when the process is restarted
+     * after a timeout or a cancelled command.
+     */
     void signalFinished(int exitCode,
                         QProcess::ExitStatus exitStatus);
 
@@ -174,6 +459,29 @@ Q_SIGNALS:
                             const QByteArray& cmdOutputChannel,
                             const QByteArray& cmdErrorChannel);
 
+    /**
+     * Emitted with the next piece of standard output of a command sent with the StreamOutput flag.
+     * Chunks are emitted in order, and all of them are emitted before signalCmdCompleted().
+     */
+    void signalCmdData(int cmdId,
+                       const QByteArray& cmdOutputChunk);
+
+    /**
+     * Emitted instead of signalCmdCompleted() for a command which will not complete.
+     */
+    void signalCmdFailed(int cmdId,
+                         Digikam::ExifToolProcess::CommandError error);
+
+    /**
+     * Emitted when the queue reaches the high water mark, see setQueueLimits().
+     */
+    void signalQueueFull();
+
+    /**
+     * Emitted when a full queue goes down to the low water mark.
+     */
+    void signalQueueDrained();
+
 private:
 
     class Private;
@@ -182,4 +490,6 @@ private:
 
 } // namespace Digikam
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(Digikam::ExifToolProcess::CommandFlags)
+
 #endif // DIGIKAM_EXIFTOOL_PROCESS_H
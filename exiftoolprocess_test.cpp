@@ -0,0 +1,173 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : regression tests of ExifToolProcess command handling.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+// Qt includes
+
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QTimer>
+#include <QSet>
+#include <QDebug>
+
+// Local includes
+
+#include "exiftoolprocess.h"
+
+using namespace Digikam;
+
+namespace
+{
+
+/**
+ * Minimal stand-in for "exiftool -stay_open true -@ -", answering each command with an empty
+ * JSON object. Without the marker file, it creates it and exits at its first command, as a crash.
+ */
+static const char FAKE_EXIFTOOL[] =
+    "#!/bin/sh\n"
+    "while IFS= read -r line ; do\n"
+    "    case \"$line\" in\n"
+    "        -echo1) IFS= read -r v ; printf '%s\\n' \"$v\" ;;\n"
+    "        -echo2) IFS= read -r v ; printf '%s\\n' \"$v\" >&2 ;;\n"
+    "        -echo3) IFS= read -r v ; echo3=\"$v\" ;;\n"
+    "        -echo4) IFS= read -r v ; echo4=\"$v\" ;;\n"
+    "        -execute*)\n"
+    "            if [ ! -e \"$EXIFTOOL_TEST_MARKER\" ] ; then : > \"$EXIFTOOL_TEST_MARKER\" ; exit 1 ; fi\n"
+    "            printf '[{\"SourceFile\": \"test\"}]\\n'\n"
+    "            printf '%s\\n' \"$echo4\" >&2\n"
+    "            if [ -z \"$echo3\" ] ; then echo3='{ready}' ; fi\n"
+    "            printf '%s\\n' \"$echo3\"\n"
+    "            echo3= ; echo4= ;;\n"
+    "    esac\n"
+    "done\n";
+
+/**
+ * A crash is followed by a respawn delay. A command sent during this delay, followed by a call
+ * to start() as the parser does, must be queued: both the replayed command and the new one complete.
+ */
+bool testCommandDuringRespawn(QCoreApplication& app, const QString& program)
+{
+    ExifToolProcess proc;
+    proc.setAutoRestart(true);
+    proc.setProgram(program);
+    proc.start();
+
+    QSet<int> expected;
+    QSet<int> completed;
+    bool failed = false;
+
+    QObject::connect(&proc, &ExifToolProcess::signalCmdCompleted,
+                     [&](int cmdId, int, const QByteArray&, const QByteArray&)
+        {
+            completed << cmdId;
+
+            if (completed == expected)
+            {
+                app.quit();
+            }
+        }
+    );
+
+    QObject::connect(&proc, &ExifToolProcess::signalCmdFailed,
+                     [&](int cmdId, ExifToolProcess::CommandError error)
+        {
+            qWarning() << "Command" << cmdId << "failed with error" << error;
+            failed = true;
+            app.quit();
+        }
+    );
+
+    QObject::connect(&proc, &ExifToolProcess::signalFinished,
+                     [&]()
+        {
+            // The respawn timer is started once signalFinished() is delivered.
+
+            QTimer::singleShot(0, [&]()
+                {
+                    const int cmdId = proc.command(QByteArrayList() << QByteArray("-json") << QByteArray("second.jpg"));
+
+                    if (cmdId == 0)
+                    {
+                        qWarning() << "Command rejected during the respawn delay";
+                        failed = true;
+                        app.quit();
+
+                        return;
+                    }
+
+                    expected << cmdId;
+
+                    if (proc.state() == QProcess::NotRunning)
+                    {
+                        proc.start();
+                    }
+                }
+            );
+        }
+    );
+
+    expected << proc.command(QByteArrayList() << QByteArray("-json") << QByteArray("first.jpg"));
+
+    QTimer::singleShot(10000, [&]()
+        {
+            qWarning() << "Timeout: completed" << completed << "expected" << expected;
+            failed = true;
+            app.quit();
+        }
+    );
+
+    app.exec();
+
+    return (!failed && (completed == expected) && (expected.size() == 2));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QTemporaryDir dir;
+
+    const QString program = dir.filePath(QLatin1String("exiftool"));
+    QFile script(program);
+
+    if (!dir.isValid() || !script.open(QIODevice::WriteOnly) || (script.write(FAKE_EXIFTOOL) <= 0))
+    {
+        qWarning() << "Cannot create the fake ExifTool program";
+        return 1;
+    }
+
+    script.close();
+    script.setPermissions(QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+    qputenv("EXIFTOOL_TEST_MARKER", QFile::encodeName(dir.filePath(QLatin1String("crashed"))));
+
+    if (!testCommandDuringRespawn(app, program))
+    {
+        qWarning() << "FAIL: testCommandDuringRespawn";
+        return 1;
+    }
+
+    qDebug() << "PASS: testCommandDuringRespawn";
+
+    return 0;
+}
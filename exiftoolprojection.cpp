@@ -0,0 +1,207 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : selection of the tags to read with ExifTool.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "exiftoolprojection.h"
+
+namespace Digikam
+{
+
+ExifToolProjection::ExifToolProjection()
+{
+}
+
+ExifToolProjection::~ExifToolProjection()
+{
+}
+
+ExifToolProjection ExifToolProjection::preset(Preset preset)
+{
+    ExifToolProjection projection;
+
+    switch (preset)
+    {
+        case ThumbnailTags:
+        {
+            projection.addTag(QLatin1String("Orientation"))
+                      .addTag(QLatin1String("ImageWidth"))
+                      .addTag(QLatin1String("ImageHeight"))
+                      .addTag(QLatin1String("MIMEType"));
+            break;
+        }
+
+        case SortingTags:
+        {
+            projection.addTag(QLatin1String("DateTimeOriginal"))
+                      .addTag(QLatin1String("CreateDate"))
+                      .addTag(QLatin1String("ModifyDate"))
+                      .addTag(QLatin1String("FileModifyDate"))
+                      .addTag(QLatin1String("Rating"))
+                      .addTag(QLatin1String("Make"))
+                      .addTag(QLatin1String("Model"))
+                      .addTag(QLatin1String("FileSize"));
+            break;
+        }
+
+        case GeolocationTags:
+        {
+            projection.addTag(QLatin1String("GPSLatitude"))
+                      .addTag(QLatin1String("GPSLongitude"))
+                      .addTag(QLatin1String("GPSAltitude"))
+                      .addTag(QLatin1String("GPSLatitudeRef"))
+                      .addTag(QLatin1String("GPSLongitudeRef"))
+                      .addTag(QLatin1String("GPSAltitudeRef"))
+                      .addTag(QLatin1String("GPSDateTime"));
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    return projection;
+}
+
+ExifToolProjection& ExifToolProjection::addTag(const QString& tag)
+{
+    const int colon = tag.lastIndexOf(QLatin1Char(':'));
+
+    m_tags      << tag.mid(colon + 1);
+    m_tagGroups << ((colon == -1) ? QString() : tag.left(colon));
+
+    return *this;
+}
+
+ExifToolProjection& ExifToolProjection::addGroup(const QString& group)
+{
+    if (!m_groups.contains(group, Qt::CaseInsensitive))
+    {
+        m_groups << group;
+    }
+
+    return *this;
+}
+
+ExifToolProjection& ExifToolProjection::excludeGroup(const QString& group)
+{
+    if (!m_excludedGroups.contains(group, Qt::CaseInsensitive))
+    {
+        m_excludedGroups << group;
+    }
+
+    return *this;
+}
+
+bool ExifToolProjection::isAll() const
+{
+    return (m_tags.isEmpty() && m_groups.isEmpty() && m_excludedGroups.isEmpty());
+}
+
+QByteArrayList ExifToolProjection::arguments() const
+{
+    QByteArrayList args;
+
+    for (int i = 0 ; i < m_tags.size() ; ++i)
+    {
+        if (m_tagGroups[i].isEmpty())
+        {
+            args << QByteArray("-") + m_tags[i].toUtf8();
+        }
+        else
+        {
+            args << QByteArray("-") + m_tagGroups[i].toUtf8() + ':' + m_tags[i].toUtf8();
+        }
+    }
+
+    for (const QString& group : m_groups)
+    {
+        args << QByteArray("-") + group.toUtf8() + ":all";
+    }
+
+    for (const QString& group : m_excludedGroups)
+    {
+        args << QByteArray("--") + group.toUtf8() + ":all";
+    }
+
+    return args;
+}
+
+bool ExifToolProjection::accepts(const ExifToolTagDictionary::Entry* const entry) const
+{
+    if (!entry)
+    {
+        return false;
+    }
+
+    for (const QString& group : m_excludedGroups)
+    {
+        if (matchesGroup(entry, group))
+        {
+            return false;
+        }
+    }
+
+    if (m_tags.isEmpty() && m_groups.isEmpty())
+    {
+        return true;
+    }
+
+    for (const QString& group : m_groups)
+    {
+        if (matchesGroup(entry, group))
+        {
+            return true;
+        }
+    }
+
+    for (int i = 0 ; i < m_tags.size() ; ++i)
+    {
+        if ((entry->tag.compare(m_tags[i], Qt::CaseInsensitive) == 0) &&
+            (m_tagGroups[i].isEmpty() || matchesGroup(entry, m_tagGroups[i])))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+QString ExifToolProjection::toString() const
+{
+    return QString::fromUtf8(arguments().join(' ')).toLower();
+}
+
+bool ExifToolProjection::operator==(const ExifToolProjection& other) const
+{
+    return (toString() == other.toString());
+}
+
+bool ExifToolProjection::matchesGroup(const ExifToolTagDictionary::Entry* const entry, const QString& group)
+{
+    return ((entry->group0.compare(group, Qt::CaseInsensitive) == 0) ||
+            (entry->group1.compare(group, Qt::CaseInsensitive) == 0) ||
+            (entry->group2.compare(group, Qt::CaseInsensitive) == 0));
+}
+
+} // namespace Digikam
@@ -0,0 +1,119 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : selection of the tags to read with ExifTool.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_EXIFTOOL_PROJECTION_H
+#define DIGIKAM_EXIFTOOL_PROJECTION_H
+
+// Qt Core
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+
+// Local includes
+
+#include "exiftooltagdictionary.h"
+
+namespace Digikam
+{
+
+/**
+ * The tags and groups a caller needs from a file. A projection is turned into ExifTool
+ * arguments, so ExifTool only extracts and prints what is requested, and is used by
+ * the parser to skip any other tag. The default projection reads all tags.
+ *
+ * Tags are given as "Tag" or "Group:Tag", groups with their name in any family,
+ * as ExifTool does, for example "EXIF", "IFD0", "GPS" or "MakerNotes".
+ */
+class ExifToolProjection
+{
+public:
+
+    enum Preset
+    {
+        AllTags = 0,
+        ThumbnailTags,                  ///< Orientation and image size, for grid thumbnails.
+        SortingTags,                    ///< Dates, rating, camera and file size, for sorting and filtering.
+        GeolocationTags                 ///< GPS position, for maps.
+    };
+
+public:
+
+    ExifToolProjection();
+    ~ExifToolProjection();
+
+    static ExifToolProjection preset(Preset preset);
+
+    /**
+     * Request a tag.
+     */
+    ExifToolProjection& addTag(const QString& tag);
+
+    /**
+     * Request all tags of a group.
+     */
+    ExifToolProjection& addGroup(const QString& group);
+
+    /**
+     * Skip all tags of a group, even if requested otherwise.
+     */
+    ExifToolProjection& excludeGroup(const QString& group);
+
+    /**
+     * Return true if no tag nor group was requested and none is excluded.
+     */
+    bool           isAll()                                          const;
+
+    /**
+     * Return the ExifTool arguments selecting the tags.
+     */
+    QByteArrayList arguments()                                      const;
+
+    /**
+     * Return true if a tag parsed from ExifTool output is part of the projection.
+     */
+    bool           accepts(const ExifToolTagDictionary::Entry* const entry) const;
+
+    /**
+     * Return a text describing the projection, equal for equivalent projections.
+     */
+    QString        toString()                                       const;
+
+    bool operator==(const ExifToolProjection& other)                const;
+
+private:
+
+    static bool    matchesGroup(const ExifToolTagDictionary::Entry* const entry, const QString& group);
+
+private:
+
+    QStringList    m_tags;              ///< Requested tag names.
+    QStringList    m_tagGroups;         ///< Group of the requested tag at the same index, or empty.
+    QStringList    m_groups;
+    QStringList    m_excludedGroups;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_EXIFTOOL_PROJECTION_H
@@ -0,0 +1,180 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : process-wide dictionary of ExifTool tag keys.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "exiftooltagdictionary.h"
+
+// Qt includes
+
+#include <QHash>
+#include <QVector>
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace Digikam
+{
+
+class Q_DECL_HIDDEN ExifToolTagDictionary::Private
+{
+public:
+
+    explicit Private()
+    {
+    }
+
+    ~Private()
+    {
+        qDeleteAll(entries);
+    }
+
+    /**
+     * Decode a raw key "Family0:Family1:Family2[:Type]:Tag" to a new entry, or return nullptr.
+     */
+    static Entry* decode(const char* const key, int keySize)
+    {
+        int colons[4];
+        int count = 0;
+
+        for (int i = 0 ; i < keySize ; ++i)
+        {
+            if (key[i] == ':')
+            {
+                if (count == 4)
+                {
+                    return nullptr;
+                }
+
+                colons[count++] = i;
+            }
+        }
+
+        if ((count != 3) && (count != 4))
+        {
+            return nullptr;
+        }
+
+        const int tagStart = colons[count - 1] + 1;
+
+        Entry* const entry = new Entry;
+        entry->key         = QByteArray(key, keySize);
+        entry->group       = QString::fromLatin1(key, colons[2]).replace(QLatin1Char(':'), QLatin1Char('.'));
+        entry->group0      = QString::fromLatin1(key, colons[0]);
+        entry->group1      = QString::fromLatin1(key + colons[0] + 1, colons[1] - colons[0] - 1);
+        entry->group2      = QString::fromLatin1(key + colons[1] + 1, colons[2] - colons[1] - 1);
+        entry->tag         = QString::fromLatin1(key + tagStart, keySize - tagStart);
+        entry->name        = entry->group + QLatin1Char('.') + entry->tag;
+
+        if (count == 4)
+        {
+            entry->type    = QString::fromLatin1(key + colons[2] + 1, colons[3] - colons[2] - 1);
+        }
+
+        return entry;
+    }
+
+public:
+
+    mutable QReadWriteLock  lock;
+    QHash<QByteArray, int>  index;              ///< Entry identifier by raw key.
+    QVector<Entry*>         entries;            ///< Entries by identifier, with stable addresses.
+};
+
+ExifToolTagDictionary* ExifToolTagDictionary::instance()
+{
+    static ExifToolTagDictionary dictionary;
+
+    return &dictionary;
+}
+
+ExifToolTagDictionary::ExifToolTagDictionary()
+    : d(new Private)
+{
+}
+
+ExifToolTagDictionary::~ExifToolTagDictionary()
+{
+    delete d;
+}
+
+const ExifToolTagDictionary::Entry* ExifToolTagDictionary::intern(const char* const key,
+                                                                  int keySize,
+                                                                  const QString& description)
+{
+    // The raw key is looked up in place, without copy.
+
+    const QByteArray rawKey = QByteArray::fromRawData(key, keySize);
+
+    {
+        QReadLocker lock(&d->lock);
+
+        QHash<QByteArray, int>::const_iterator it = d->index.constFind(rawKey);
+
+        if (it != d->index.constEnd())
+        {
+            return d->entries[it.value()];
+        }
+    }
+
+    Entry* const entry = Private::decode(key, keySize);
+
+    if (!entry)
+    {
+        return nullptr;
+    }
+
+    QWriteLocker lock(&d->lock);
+
+    // Another thread may have added the key in the meantime.
+
+    QHash<QByteArray, int>::const_iterator it = d->index.constFind(rawKey);
+
+    if (it != d->index.constEnd())
+    {
+        delete entry;
+
+        return d->entries[it.value()];
+    }
+
+    entry->id          = d->entries.size();
+    entry->description = description;
+    d->entries.append(entry);
+    d->index.insert(entry->key, entry->id);
+
+    return entry;
+}
+
+const ExifToolTagDictionary::Entry* ExifToolTagDictionary::entry(int id) const
+{
+    QReadLocker lock(&d->lock);
+
+    return (((id >= 0) && (id < d->entries.size())) ? d->entries[id] : nullptr);
+}
+
+int ExifToolTagDictionary::size() const
+{
+    QReadLocker lock(&d->lock);
+
+    return d->entries.size();
+}
+
+} // namespace Digikam
@@ -0,0 +1,105 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : process-wide dictionary of ExifTool tag keys.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_EXIFTOOL_TAG_DICTIONARY_H
+#define DIGIKAM_EXIFTOOL_TAG_DICTIONARY_H
+
+// Qt Core
+
+#include <QString>
+#include <QByteArray>
+
+namespace Digikam
+{
+
+/**
+ * Interning dictionary of the tag keys returned by ExifTool with -G:0:1:2:4:6, such as
+ * "EXIF:IFD0:Image:int16u:Orientation". Each distinct key is decoded once per process
+ * to an entry with a stable integer identifier and pre-built names, shared by all
+ * loaded files. Looking up a known key is one hash probe. All functions are thread-safe.
+ */
+class ExifToolTagDictionary
+{
+public:
+
+    /**
+     * Decoded tag key. Entries are never modified nor destroyed once created.
+     */
+    class Entry
+    {
+    public:
+
+        Entry()
+          : id(-1)
+        {
+        }
+
+        int        id;                  ///< Stable identifier, index in the dictionary.
+        QByteArray key;                 ///< Raw ExifTool key.
+        QString    name;                ///< Tag name, "Family0.Family1.Family2.Tag".
+        QString    group;               ///< "Family0.Family1.Family2".
+        QString    group0;              ///< Family 0 group, as "EXIF".
+        QString    group1;              ///< Family 1 group, as "IFD0".
+        QString    group2;              ///< Family 2 group, as "Image".
+        QString    tag;                 ///< Tag name without group.
+        QString    type;                ///< ExifTool format type, as "int16u", or empty.
+        QString    description;         ///< Description of the tag when it was first seen.
+    };
+
+public:
+
+    static ExifToolTagDictionary* instance();
+
+    /**
+     * Return the entry of a raw key, created on first use. The description is recorded
+     * with a new entry. Return nullptr if the key does not have the expected form.
+     */
+    const Entry* intern(const char* const key,
+                        int keySize,
+                        const QString& description = QString());
+
+    /**
+     * Return the entry of an identifier, or nullptr.
+     */
+    const Entry* entry(int id) const;
+
+    int          size()        const;
+
+private:
+
+    ExifToolTagDictionary();
+    ~ExifToolTagDictionary();
+
+    // Disable
+    ExifToolTagDictionary(const ExifToolTagDictionary&)            = delete;
+    ExifToolTagDictionary& operator=(const ExifToolTagDictionary&) = delete;
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_EXIFTOOL_TAG_DICTIONARY_H
@@ -0,0 +1,477 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : compact storage of the tags parsed from a file.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "exiftooltagstore.h"
+
+// C++ includes
+
+#include <algorithm>
+
+namespace Digikam
+{
+
+namespace
+{
+
+int compareUtf16(const QChar* const a, int aSize, const QChar* const b, int bSize)
+{
+    const int size = qMin(aSize, bSize);
+
+    for (int i = 0 ; i < size ; ++i)
+    {
+        if (a[i] != b[i])
+        {
+            return ((a[i].unicode() < b[i].unicode()) ? -1 : 1);
+        }
+    }
+
+    return (aSize - bSize);
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------------------------
+
+ExifToolTagStore::Tag::Tag(const ExifToolTagStore* const store, int index)
+    : m_store(store),
+      m_index(index)
+{
+}
+
+QString ExifToolTagStore::Tag::key() const
+{
+    const Record& record = m_store->m_records[m_index];
+
+    return (record.entry ? record.entry->name : m_store->string(record.key));
+}
+
+QString ExifToolTagStore::Tag::name() const
+{
+    return m_store->string(m_store->m_records[m_index].name);
+}
+
+QString ExifToolTagStore::Tag::type() const
+{
+    const Record& record = m_store->m_records[m_index];
+
+    return (record.entry ? record.entry->type : m_store->string(record.type));
+}
+
+QString ExifToolTagStore::Tag::description() const
+{
+    const Record& record = m_store->m_records[m_index];
+
+    return ((record.entry && !record.desc.size) ? record.entry->description : m_store->string(record.desc));
+}
+
+int ExifToolTagStore::Tag::tagId() const
+{
+    const Record& record = m_store->m_records[m_index];
+
+    return (record.entry ? record.entry->id : -1);
+}
+
+ExifToolTagStore::ValueType ExifToolTagStore::Tag::valueType() const
+{
+    return m_store->m_records[m_index].valueType;
+}
+
+QVariant ExifToolTagStore::Tag::value() const
+{
+    const Record& record = m_store->m_records[m_index];
+
+    switch (record.valueType)
+    {
+        case StringValue:
+            return m_store->string(record.text);
+
+        case IntegerValue:
+            return record.number.integer;
+
+        case DoubleValue:
+            return record.number.real;
+
+        case BytesValue:
+            return m_store->m_bytes.mid(record.text.offset, record.text.size);
+
+        default:
+            return QVariant();
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+ExifToolTagStore::const_iterator::const_iterator(const ExifToolTagStore* const store, int index)
+    : m_store(store),
+      m_index(index)
+{
+}
+
+ExifToolTagStore::Tag ExifToolTagStore::const_iterator::operator*() const
+{
+    return Tag(m_store, m_index);
+}
+
+ExifToolTagStore::const_iterator& ExifToolTagStore::const_iterator::operator++()
+{
+    ++m_index;
+
+    return *this;
+}
+
+bool ExifToolTagStore::const_iterator::operator==(const const_iterator& other) const
+{
+    return ((m_store == other.m_store) && (m_index == other.m_index));
+}
+
+bool ExifToolTagStore::const_iterator::operator!=(const const_iterator& other) const
+{
+    return !(*this == other);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+ExifToolTagStore::ExifToolTagStore()
+    : m_sorted(true)
+{
+}
+
+ExifToolTagStore::~ExifToolTagStore()
+{
+}
+
+ExifToolTagStore::Slice ExifToolTagStore::addString(const QString& str)
+{
+    Slice slice;
+    slice.offset = m_strings.size();
+    slice.size   = str.size();
+    m_strings.append(str);
+
+    return slice;
+}
+
+QString ExifToolTagStore::string(const Slice& slice) const
+{
+    return QString(m_strings.constData() + slice.offset, slice.size);
+}
+
+void ExifToolTagStore::insert(const QString& key,
+                              const QString& name,
+                              const QVariant& value,
+                              const QString& type,
+                              const QString& description)
+{
+    Record record;
+    record.key  = addString(key);
+    record.name = addString(name);
+    record.desc = addString(description);
+
+    QHash<QString, Slice>::const_iterator it = m_types.constFind(type);
+
+    if (it != m_types.constEnd())
+    {
+        record.type = it.value();
+    }
+    else
+    {
+        record.type = addString(type);
+        m_types.insert(type, record.type);
+    }
+
+    setValue(record, value);
+    append(record);
+}
+
+void ExifToolTagStore::insert(const ExifToolTagDictionary::Entry* const entry,
+                              const QVariant& value,
+                              const QString& description)
+{
+    Record record;
+    record.entry = entry;
+
+    if (description != entry->description)
+    {
+        record.desc = addString(description);
+    }
+
+    setValue(record, value);
+    append(record);
+}
+
+void ExifToolTagStore::append(const Record& record)
+{
+    m_records.append(record);
+    m_sorted = (m_records.size() == 1);
+}
+
+void ExifToolTagStore::setValue(Record& record, const QVariant& value)
+{
+    switch (value.type())
+    {
+        case QVariant::Invalid:
+        {
+            record.valueType = NoValue;
+            break;
+        }
+
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+        case QVariant::Bool:
+        {
+            record.valueType      = IntegerValue;
+            record.number.integer = value.toLongLong();
+            break;
+        }
+
+        case QVariant::Double:
+        {
+            record.valueType      = DoubleValue;
+            record.number.real    = value.toDouble();
+            break;
+        }
+
+        case QVariant::ByteArray:
+        {
+            const QByteArray bytes = value.toByteArray();
+            record.valueType       = BytesValue;
+            record.text.offset     = m_bytes.size();
+            record.text.size       = bytes.size();
+            m_bytes.append(bytes);
+            break;
+        }
+
+        default:
+        {
+            record.valueType       = StringValue;
+            record.text            = addString(value.toString());
+            break;
+        }
+    }
+}
+
+void ExifToolTagStore::squeeze()
+{
+    if (!m_sorted)
+    {
+        // Stable sort: among identical keys, the last inserted tag is the last one, and is kept.
+
+        std::stable_sort(m_records.begin(), m_records.end(),
+                         [this](const Record& a, const Record& b)
+            {
+                int aSize                = 0;
+                int bSize                = 0;
+                const QChar* const aData = keyData(a, aSize);
+                const QChar* const bData = keyData(b, bSize);
+
+                return (compareUtf16(aData, aSize, bData, bSize) < 0);
+            }
+        );
+
+        int last = 0;
+
+        for (int i = 1 ; i < m_records.size() ; ++i)
+        {
+            int size                    = 0;
+            int lastSize                = 0;
+            const QChar* const data     = keyData(m_records[i], size);
+            const QChar* const lastData = keyData(m_records[last], lastSize);
+
+            if (compareUtf16(data, size, lastData, lastSize) != 0)
+            {
+                ++last;
+            }
+
+            m_records[last] = m_records[i];
+        }
+
+        m_records.resize(m_records.isEmpty() ? 0 : (last + 1));
+        m_sorted = true;
+    }
+
+    m_types.clear();
+    m_records.squeeze();
+    m_strings.squeeze();
+    m_bytes.squeeze();
+}
+
+void ExifToolTagStore::clear()
+{
+    m_records.clear();
+    m_strings.clear();
+    m_bytes.clear();
+    m_types.clear();
+    m_sorted = true;
+}
+
+int ExifToolTagStore::size() const
+{
+    return m_records.size();
+}
+
+bool ExifToolTagStore::isEmpty() const
+{
+    return m_records.isEmpty();
+}
+
+const QChar* ExifToolTagStore::keyData(const Record& record, int& size) const
+{
+    if (record.entry)
+    {
+        size = record.entry->name.size();
+
+        return record.entry->name.constData();
+    }
+
+    size = record.key.size;
+
+    return (m_strings.constData() + record.key.offset);
+}
+
+int ExifToolTagStore::compareKey(int index, const QChar* const key, int size) const
+{
+    int recordSize                = 0;
+    const QChar* const recordData = keyData(m_records[index], recordSize);
+
+    return compareUtf16(recordData, recordSize, key, size);
+}
+
+int ExifToolTagStore::indexOf(const QString& key) const
+{
+    if (!m_sorted)
+    {
+        // Not squeezed yet: the last inserted tag wins.
+
+        for (int i = m_records.size() - 1 ; i >= 0 ; --i)
+        {
+            if (compareKey(i, key.constData(), key.size()) == 0)
+            {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    int low  = 0;
+    int high = m_records.size() - 1;
+
+    while (low <= high)
+    {
+        const int mid = (low + high) / 2;
+        const int cmp = compareKey(mid, key.constData(), key.size());
+
+        if      (cmp < 0)
+        {
+            low  = mid + 1;
+        }
+        else if (cmp > 0)
+        {
+            high = mid - 1;
+        }
+        else
+        {
+            return mid;
+        }
+    }
+
+    return -1;
+}
+
+bool ExifToolTagStore::contains(const QString& key) const
+{
+    return (indexOf(key) != -1);
+}
+
+ExifToolTagStore::const_iterator ExifToolTagStore::find(const QString& key) const
+{
+    const int index = indexOf(key);
+
+    return const_iterator(this, (index == -1) ? m_records.size() : index);
+}
+
+QVariant ExifToolTagStore::value(const QString& key) const
+{
+    const int index = indexOf(key);
+
+    return ((index == -1) ? QVariant() : Tag(this, index).value());
+}
+
+ExifToolTagStore::const_iterator ExifToolTagStore::begin() const
+{
+    return const_iterator(this, 0);
+}
+
+ExifToolTagStore::const_iterator ExifToolTagStore::end() const
+{
+    return const_iterator(this, m_records.size());
+}
+
+int ExifToolTagStore::memoryUsage() const
+{
+    return (int)(sizeof(ExifToolTagStore)                  +
+                 m_records.capacity() * sizeof(Record)     +
+                 m_strings.capacity() * sizeof(QChar)      +
+                 m_bytes.capacity());
+}
+
+ExifToolTagStore::TagsMap ExifToolTagStore::toTagsMap() const
+{
+    TagsMap map;
+    map.reserve(m_records.size());
+
+    for (const_iterator it = begin() ; it != end() ; ++it)
+    {
+        const Tag tag = *it;
+
+        map.insert(tag.key(), QVariantList() << tag.name()
+                                             << tag.value()
+                                             << tag.type()
+                                             << tag.description());
+    }
+
+    return map;
+}
+
+ExifToolTagStore ExifToolTagStore::fromTagsMap(const TagsMap& map)
+{
+    ExifToolTagStore store;
+
+    for (TagsMap::const_iterator it = map.constBegin() ; it != map.constEnd() ; ++it)
+    {
+        const QVariantList& props = it.value();
+
+        store.insert(it.key(),
+                     props.value(0).toString(),
+                     props.value(1),
+                     props.value(2).toString(),
+                     props.value(3).toString());
+    }
+
+    store.squeeze();
+
+    return store;
+}
+
+} // namespace Digikam
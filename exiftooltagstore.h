@@ -0,0 +1,228 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : compact storage of the tags parsed from a file.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_EXIFTOOL_TAG_STORE_H
+#define DIGIKAM_EXIFTOOL_TAG_STORE_H
+
+// Qt Core
+
+#include <QString>
+#include <QByteArray>
+#include <QVariant>
+#include <QVector>
+#include <QHash>
+
+// Local includes
+
+#include "exiftooltagdictionary.h"
+
+namespace Digikam
+{
+
+/**
+ * The tags of one file, stored contiguously: one flat array of fixed size records,
+ * with all strings in one arena and the values in typed slots. Records are sorted
+ * by key with squeeze(), to find a tag with a binary search.
+ * Compared to a TagsMap, a tag costs no heap allocation, and the store is implicitly
+ * shared and cheap to copy.
+ */
+class ExifToolTagStore
+{
+public:
+
+    /**
+     * A map used to store Tags Key and a list of Tags properties:
+     * name, value, type and description. See ExifToolParser::TagsMap.
+     */
+    typedef QHash<QString, QVariantList> TagsMap;
+
+    enum ValueType
+    {
+        NoValue = 0,
+        StringValue,
+        IntegerValue,
+        DoubleValue,
+        BytesValue
+    };
+
+private:
+
+    struct Slice
+    {
+        Slice()
+          : offset(0),
+            size  (0)
+        {
+        }
+
+        quint32 offset;
+        quint32 size;
+    };
+
+    struct Record
+    {
+        Record()
+          : entry    (nullptr),
+            valueType(NoValue)
+        {
+            number.integer = 0;
+        }
+
+        const ExifToolTagDictionary::Entry* entry;      ///< Shared key, type and description, or nullptr.
+        Slice     key;
+        Slice     name;
+        Slice     type;
+        Slice     desc;
+        Slice     text;                 ///< String value in the string arena, or bytes value in the bytes arena.
+
+        union
+        {
+            qint64 integer;
+            double real;
+        }         number;
+
+        ValueType valueType;
+    };
+
+public:
+
+    /**
+     * A read-only view on one tag of the store.
+     */
+    class Tag
+    {
+    public:
+
+        QString   key()         const;
+        QString   name()        const;  ///< ExifTool or Exiv2 tag name, depending on the key.
+        QVariant  value()       const;
+        ValueType valueType()   const;
+        QString   type()        const;
+        QString   description() const;
+        int       tagId()       const;  ///< Identifier in ExifToolTagDictionary, or -1.
+
+    private:
+
+        Tag(const ExifToolTagStore* const store, int index);
+
+    private:
+
+        const ExifToolTagStore* m_store;
+        int                     m_index;
+
+        friend class ExifToolTagStore;
+    };
+
+    class const_iterator
+    {
+    public:
+
+        Tag             operator*()                              const;
+        const_iterator& operator++();
+        bool            operator==(const const_iterator& other)  const;
+        bool            operator!=(const const_iterator& other)  const;
+
+    private:
+
+        const_iterator(const ExifToolTagStore* const store, int index);
+
+    private:
+
+        const ExifToolTagStore* m_store;
+        int                     m_index;
+
+        friend class ExifToolTagStore;
+    };
+
+public:
+
+    ExifToolTagStore();
+    ~ExifToolTagStore();
+
+    /**
+     * Add a tag. A tag already stored with the same key is replaced by squeeze().
+     */
+    void           insert(const QString& key,
+                          const QString& name,
+                          const QVariant& value,
+                          const QString& type,
+                          const QString& description);
+
+    /**
+     * Add a tag named after a dictionary entry, which holds the key, the type, and the description
+     * if it is the same. The strings are shared with all the stores, only the value is stored.
+     */
+    void           insert(const ExifToolTagDictionary::Entry* const entry,
+                          const QVariant& value,
+                          const QString& description);
+
+    /**
+     * Sort the tags by key, drop the replaced ones and release the unused memory.
+     * To call when all tags are inserted: lookups are linear until then.
+     */
+    void           squeeze();
+
+    void           clear();
+    int            size()                       const;
+    bool           isEmpty()                    const;
+
+    bool           contains(const QString& key) const;
+    const_iterator find(const QString& key)     const;
+    QVariant       value(const QString& key)    const;
+
+    const_iterator begin()                      const;
+    const_iterator end()                        const;
+
+    /**
+     * Return the approximate memory used by the store, in bytes.
+     */
+    int            memoryUsage()                const;
+
+    /**
+     * Conversion from and to the TagsMap representation.
+     */
+    TagsMap        toTagsMap()                  const;
+    static ExifToolTagStore fromTagsMap(const TagsMap& map);
+
+private:
+
+    Slice          addString(const QString& str);
+    QString        string(const Slice& slice)   const;
+    void           setValue(Record& record, const QVariant& value);
+    void           append(const Record& record);
+    const QChar*   keyData(const Record& record, int& size) const;
+    int            compareKey(int index, const QChar* const key, int size) const;
+    int            indexOf(const QString& key)  const;
+
+private:
+
+    QVector<Record>       m_records;
+    QString               m_strings;          ///< Arena of all strings.
+    QByteArray            m_bytes;            ///< Arena of the byte array values.
+    QHash<QString, Slice> m_types;            ///< Type names are few: stored once.
+    bool                  m_sorted;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_EXIFTOOL_TAG_STORE_H
@@ -0,0 +1,389 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : translation of ExifTool tag names to Exiv2.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "exiftooltranslator.h"
+
+// Qt includes
+
+#include <QVector>
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace Digikam
+{
+
+namespace
+{
+
+constexpr quint32 FNV_OFFSET = 2166136261U;
+constexpr quint32 FNV_PRIME  = 16777619U;
+
+/**
+ * FNV-1a hash of a string literal, evaluated by the compiler in case labels.
+ */
+constexpr quint32 fnv1a(const char* const str, quint32 hash = FNV_OFFSET)
+{
+    return (*str ? fnv1a(str + 1, (hash ^ (quint32)(quint8)*str) * FNV_PRIME) : hash);
+}
+
+/**
+ * Same hash of a string at run time. ExifTool names are ASCII.
+ */
+inline quint32 hashOf(const QChar* const str, int size, quint32 hash = FNV_OFFSET)
+{
+    for (int i = 0 ; i < size ; ++i)
+    {
+        hash = (hash ^ (quint32)(quint8)str[i].unicode()) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * Check the string matching a hash, without allocation.
+ */
+inline bool equals(const QChar* const str, int size, const char* const literal)
+{
+    int i = 0;
+
+    for ( ; i < size ; ++i)
+    {
+        if ((literal[i] == '\0') || (str[i].unicode() != (ushort)(quint8)literal[i]))
+        {
+            return false;
+        }
+    }
+
+    return (literal[i] == '\0');
+}
+
+/**
+ * Return true if a group name, as "File.System", is a group without Exiv2 equivalent.
+ */
+bool isIgnoredGroupName(const QChar* const str, int size, quint32 hash)
+{
+    const char* group = nullptr;
+
+    switch (hash)
+    {
+        case fnv1a("ExifTool"):         group = "ExifTool";         break;
+        case fnv1a("File.System"):      group = "File.System";      break;
+        case fnv1a("File.File"):        group = "File.File";        break;
+        case fnv1a("Composite"):        group = "Composite";        break;
+        case fnv1a("JFIF"):             group = "JFIF";             break;
+        case fnv1a("ICC_Profile"):      group = "ICC_Profile";      break;
+        case fnv1a("PrintIM"):          group = "PrintIM";          break;
+        default:                                                    break;
+    }
+
+    return (group && equals(str, size, group));
+}
+
+} // namespace
+
+class Q_DECL_HIDDEN ExifToolTranslator::Private
+{
+public:
+
+    explicit Private()
+    {
+    }
+
+    ~Private()
+    {
+        qDeleteAll(cache);
+    }
+
+public:
+
+    mutable QReadWriteLock  lock;
+    QVector<Translation*>   cache;              ///< Translations by dictionary entry identifier, or nullptr if not yet computed.
+};
+
+ExifToolTranslator* ExifToolTranslator::instance()
+{
+    static ExifToolTranslator translator;
+
+    return &translator;
+}
+
+ExifToolTranslator::ExifToolTranslator()
+    : d(new Private)
+{
+}
+
+ExifToolTranslator::~ExifToolTranslator()
+{
+    delete d;
+}
+
+ExifToolTranslator::Translation ExifToolTranslator::translate(const ExifToolTagDictionary::Entry* const entry)
+{
+    {
+        QReadLocker lock(&d->lock);
+
+        if ((entry->id < d->cache.size()) && d->cache[entry->id])
+        {
+            return *d->cache[entry->id];
+        }
+    }
+
+    Translation* const translation = new Translation;
+    translation->ignoredGroup      = isIgnoredGroup(entry->name);
+    translation->exiv2Name         = translateToExiv2(entry->name);
+    translation->typeCode          = typeCode(entry->type);
+
+    QWriteLocker lock(&d->lock);
+
+    if (entry->id >= d->cache.size())
+    {
+        d->cache.resize(entry->id + 1);
+    }
+
+    // Another thread may have translated the entry in the meantime.
+
+    if (d->cache[entry->id])
+    {
+        delete translation;
+    }
+    else
+    {
+        d->cache[entry->id] = translation;
+    }
+
+    return *d->cache[entry->id];
+}
+
+bool ExifToolTranslator::isIgnoredGroup(const QString& tagName) const
+{
+    // Check all the group prefixes of the name in one pass, as "File" then "File.System".
+
+    const QChar* const str = tagName.constData();
+    const int size         = tagName.size();
+    quint32 hash           = FNV_OFFSET;
+
+    for (int i = 0 ; i < size ; ++i)
+    {
+        if ((str[i] == QLatin1Char('.')) && isIgnoredGroupName(str, i, hash))
+        {
+            return true;
+        }
+
+        hash = (hash ^ (quint32)(quint8)str[i].unicode()) * FNV_PRIME;
+    }
+
+    return false;
+}
+
+ExifToolTranslator::TypeCode ExifToolTranslator::typeCode(const QString& type)
+{
+    const char* name = nullptr;
+    TypeCode code    = UnknownType;
+
+    switch (hashOf(type.constData(), type.size()))
+    {
+        case fnv1a("string"):       name = "string";        code = StringType;      break;
+        case fnv1a("int8u"):        name = "int8u";         code = IntegerType;     break;
+        case fnv1a("int16u"):       name = "int16u";        code = IntegerType;     break;
+        case fnv1a("int32u"):       name = "int32u";        code = IntegerType;     break;
+        case fnv1a("int8s"):        name = "int8s";         code = IntegerType;     break;
+        case fnv1a("int16s"):       name = "int16s";        code = IntegerType;     break;
+        case fnv1a("int32s"):       name = "int32s";        code = IntegerType;     break;
+        case fnv1a("undef"):        name = "undef";         code = UndefinedType;   break;
+        case fnv1a("double"):       name = "double";        code = RealType;        break;
+        case fnv1a("float"):        name = "float";         code = RealType;        break;
+        case fnv1a("rational64s"):  name = "rational64s";   code = RealType;        break;
+        case fnv1a("rational64u"):  name = "rational64u";   code = RealType;        break;
+        default:                                                                    break;
+    }
+
+    return ((name && equals(type.constData(), type.size(), name)) ? code : UnknownType);
+}
+
+QLatin1String ExifToolTranslator::translateToExiv2(const QString& tagName) const
+{
+    const char* exifTool = nullptr;
+    const char* exiv2    = nullptr;
+
+    // Each line maps an ExifTool name, with -G:0:1:2 groups, to the Exiv2 name.
+
+#define EXIFTOOL_TAG(et, ev) case fnv1a(et): exifTool = et; exiv2 = ev; break;
+
+    switch (hashOf(tagName.constData(), tagName.size()))
+    {
+        // --- EXIF -------------------------------------------------------------------------------
+
+        EXIFTOOL_TAG("EXIF.IFD0.Camera.Make",                   "Exif.Image.Make")
+        EXIFTOOL_TAG("EXIF.IFD0.Camera.Model",                  "Exif.Image.Model")
+        EXIFTOOL_TAG("EXIF.IFD0.Image.ImageDescription",        "Exif.Image.ImageDescription")
+        EXIFTOOL_TAG("EXIF.IFD0.Image.Orientation",             "Exif.Image.Orientation")
+        EXIFTOOL_TAG("EXIF.IFD0.Image.XResolution",             "Exif.Image.XResolution")
+        EXIFTOOL_TAG("EXIF.IFD0.Image.YResolution",             "Exif.Image.YResolution")
+        EXIFTOOL_TAG("EXIF.IFD0.Image.ResolutionUnit",          "Exif.Image.ResolutionUnit")
+        EXIFTOOL_TAG("EXIF.IFD0.Image.Software",                "Exif.Image.Software")
+        EXIFTOOL_TAG("EXIF.IFD0.Image.YCbCrPositioning",        "Exif.Image.YCbCrPositioning")
+        EXIFTOOL_TAG("EXIF.IFD0.Time.ModifyDate",               "Exif.Image.DateTime")
+        EXIFTOOL_TAG("EXIF.IFD0.Author.Artist",                 "Exif.Image.Artist")
+        EXIFTOOL_TAG("EXIF.IFD0.Author.Copyright",              "Exif.Image.Copyright")
+        EXIFTOOL_TAG("EXIF.IFD0.Image.Rating",                  "Exif.Image.Rating")
+        EXIFTOOL_TAG("EXIF.IFD0.Image.RatingPercent",           "Exif.Image.RatingPercent")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.ExposureTime",        "Exif.Photo.ExposureTime")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.FNumber",             "Exif.Photo.FNumber")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.ExposureProgram",     "Exif.Photo.ExposureProgram")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.ISO",                 "Exif.Photo.ISOSpeedRatings")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.ExifVersion",         "Exif.Photo.ExifVersion")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Time.DateTimeOriginal",      "Exif.Photo.DateTimeOriginal")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Time.CreateDate",            "Exif.Photo.DateTimeDigitized")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Time.OffsetTime",            "Exif.Photo.OffsetTime")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Time.OffsetTimeOriginal",    "Exif.Photo.OffsetTimeOriginal")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Time.SubSecTimeOriginal",    "Exif.Photo.SubSecTimeOriginal")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Image.ComponentsConfiguration", "Exif.Photo.ComponentsConfiguration")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.ShutterSpeedValue",   "Exif.Photo.ShutterSpeedValue")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.ApertureValue",       "Exif.Photo.ApertureValue")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.BrightnessValue",     "Exif.Photo.BrightnessValue")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.ExposureCompensation", "Exif.Photo.ExposureBiasValue")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.MaxApertureValue",    "Exif.Photo.MaxApertureValue")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.SubjectDistance",     "Exif.Photo.SubjectDistance")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.MeteringMode",        "Exif.Photo.MeteringMode")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.LightSource",         "Exif.Photo.LightSource")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.Flash",               "Exif.Photo.Flash")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.FocalLength",         "Exif.Photo.FocalLength")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Image.UserComment",          "Exif.Photo.UserComment")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Image.FlashpixVersion",      "Exif.Photo.FlashpixVersion")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Image.ColorSpace",           "Exif.Photo.ColorSpace")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Image.ExifImageWidth",       "Exif.Photo.PixelXDimension")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Image.ExifImageHeight",      "Exif.Photo.PixelYDimension")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.SensingMethod",       "Exif.Photo.SensingMethod")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Image.FileSource",           "Exif.Photo.FileSource")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Image.SceneType",            "Exif.Photo.SceneType")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Image.CustomRendered",       "Exif.Photo.CustomRendered")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.ExposureMode",        "Exif.Photo.ExposureMode")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.WhiteBalance",        "Exif.Photo.WhiteBalance")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.DigitalZoomRatio",    "Exif.Photo.DigitalZoomRatio")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.FocalLengthIn35mmFormat", "Exif.Photo.FocalLengthIn35mmFilm")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.SceneCaptureType",    "Exif.Photo.SceneCaptureType")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.GainControl",         "Exif.Photo.GainControl")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.Contrast",            "Exif.Photo.Contrast")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.Saturation",          "Exif.Photo.Saturation")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.Sharpness",           "Exif.Photo.Sharpness")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.SubjectDistanceRange", "Exif.Photo.SubjectDistanceRange")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Image.ImageUniqueID",        "Exif.Photo.ImageUniqueID")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Author.OwnerName",           "Exif.Photo.CameraOwnerName")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.SerialNumber",        "Exif.Photo.BodySerialNumber")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.LensInfo",            "Exif.Photo.LensSpecification")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.LensMake",            "Exif.Photo.LensMake")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.LensModel",           "Exif.Photo.LensModel")
+        EXIFTOOL_TAG("EXIF.ExifIFD.Camera.LensSerialNumber",    "Exif.Photo.LensSerialNumber")
+        EXIFTOOL_TAG("EXIF.GPS.Location.GPSVersionID",          "Exif.GPSInfo.GPSVersionID")
+        EXIFTOOL_TAG("EXIF.GPS.Location.GPSLatitudeRef",        "Exif.GPSInfo.GPSLatitudeRef")
+        EXIFTOOL_TAG("EXIF.GPS.Location.GPSLatitude",           "Exif.GPSInfo.GPSLatitude")
+        EXIFTOOL_TAG("EXIF.GPS.Location.GPSLongitudeRef",       "Exif.GPSInfo.GPSLongitudeRef")
+        EXIFTOOL_TAG("EXIF.GPS.Location.GPSLongitude",          "Exif.GPSInfo.GPSLongitude")
+        EXIFTOOL_TAG("EXIF.GPS.Location.GPSAltitudeRef",        "Exif.GPSInfo.GPSAltitudeRef")
+        EXIFTOOL_TAG("EXIF.GPS.Location.GPSAltitude",           "Exif.GPSInfo.GPSAltitude")
+        EXIFTOOL_TAG("EXIF.GPS.Time.GPSTimeStamp",              "Exif.GPSInfo.GPSTimeStamp")
+        EXIFTOOL_TAG("EXIF.GPS.Location.GPSMapDatum",           "Exif.GPSInfo.GPSMapDatum")
+        EXIFTOOL_TAG("EXIF.GPS.Location.GPSImgDirectionRef",    "Exif.GPSInfo.GPSImgDirectionRef")
+        EXIFTOOL_TAG("EXIF.GPS.Location.GPSImgDirection",       "Exif.GPSInfo.GPSImgDirection")
+        EXIFTOOL_TAG("EXIF.GPS.Time.GPSDateStamp",              "Exif.GPSInfo.GPSDateStamp")
+
+        // --- IPTC -------------------------------------------------------------------------------
+
+        EXIFTOOL_TAG("IPTC.IPTC.Other.ObjectName",              "Iptc.Application2.ObjectName")
+        EXIFTOOL_TAG("IPTC.IPTC.Other.Urgency",                 "Iptc.Application2.Urgency")
+        EXIFTOOL_TAG("IPTC.IPTC.Other.Category",                "Iptc.Application2.Category")
+        EXIFTOOL_TAG("IPTC.IPTC.Other.SupplementalCategories",  "Iptc.Application2.SuppCategory")
+        EXIFTOOL_TAG("IPTC.IPTC.Other.Keywords",                "Iptc.Application2.Keywords")
+        EXIFTOOL_TAG("IPTC.IPTC.Other.SpecialInstructions",     "Iptc.Application2.SpecialInstructions")
+        EXIFTOOL_TAG("IPTC.IPTC.Time.DateCreated",              "Iptc.Application2.DateCreated")
+        EXIFTOOL_TAG("IPTC.IPTC.Time.TimeCreated",              "Iptc.Application2.TimeCreated")
+        EXIFTOOL_TAG("IPTC.IPTC.Author.By-line",                "Iptc.Application2.Byline")
+        EXIFTOOL_TAG("IPTC.IPTC.Author.By-lineTitle",           "Iptc.Application2.BylineTitle")
+        EXIFTOOL_TAG("IPTC.IPTC.Location.City",                 "Iptc.Application2.City")
+        EXIFTOOL_TAG("IPTC.IPTC.Location.Sub-location",         "Iptc.Application2.SubLocation")
+        EXIFTOOL_TAG("IPTC.IPTC.Location.Province-State",       "Iptc.Application2.ProvinceState")
+        EXIFTOOL_TAG("IPTC.IPTC.Location.Country-PrimaryLocationCode", "Iptc.Application2.CountryCode")
+        EXIFTOOL_TAG("IPTC.IPTC.Location.Country-PrimaryLocationName", "Iptc.Application2.CountryName")
+        EXIFTOOL_TAG("IPTC.IPTC.Other.OriginalTransmissionReference",  "Iptc.Application2.TransmissionReference")
+        EXIFTOOL_TAG("IPTC.IPTC.Other.Headline",                "Iptc.Application2.Headline")
+        EXIFTOOL_TAG("IPTC.IPTC.Author.Credit",                 "Iptc.Application2.Credit")
+        EXIFTOOL_TAG("IPTC.IPTC.Author.Source",                 "Iptc.Application2.Source")
+        EXIFTOOL_TAG("IPTC.IPTC.Author.CopyrightNotice",        "Iptc.Application2.Copyright")
+        EXIFTOOL_TAG("IPTC.IPTC.Other.Caption-Abstract",        "Iptc.Application2.Caption")
+        EXIFTOOL_TAG("IPTC.IPTC.Author.Writer-Editor",          "Iptc.Application2.Writer")
+
+        // --- XMP --------------------------------------------------------------------------------
+
+        EXIFTOOL_TAG("XMP.XMP-dc.Author.Creator",               "Xmp.dc.creator")
+        EXIFTOOL_TAG("XMP.XMP-dc.Author.Rights",                "Xmp.dc.rights")
+        EXIFTOOL_TAG("XMP.XMP-dc.Image.Description",            "Xmp.dc.description")
+        EXIFTOOL_TAG("XMP.XMP-dc.Image.Subject",                "Xmp.dc.subject")
+        EXIFTOOL_TAG("XMP.XMP-dc.Image.Title",                  "Xmp.dc.title")
+        EXIFTOOL_TAG("XMP.XMP-dc.Image.Format",                 "Xmp.dc.format")
+        EXIFTOOL_TAG("XMP.XMP-xmp.Image.CreatorTool",           "Xmp.xmp.CreatorTool")
+        EXIFTOOL_TAG("XMP.XMP-xmp.Image.Rating",                "Xmp.xmp.Rating")
+        EXIFTOOL_TAG("XMP.XMP-xmp.Time.CreateDate",             "Xmp.xmp.CreateDate")
+        EXIFTOOL_TAG("XMP.XMP-xmp.Time.ModifyDate",             "Xmp.xmp.ModifyDate")
+        EXIFTOOL_TAG("XMP.XMP-xmp.Time.MetadataDate",           "Xmp.xmp.MetadataDate")
+        EXIFTOOL_TAG("XMP.XMP-photoshop.Time.DateCreated",      "Xmp.photoshop.DateCreated")
+        EXIFTOOL_TAG("XMP.XMP-photoshop.Location.City",         "Xmp.photoshop.City")
+        EXIFTOOL_TAG("XMP.XMP-photoshop.Location.State",        "Xmp.photoshop.State")
+        EXIFTOOL_TAG("XMP.XMP-photoshop.Location.Country",      "Xmp.photoshop.Country")
+        EXIFTOOL_TAG("XMP.XMP-photoshop.Image.Headline",        "Xmp.photoshop.Headline")
+        EXIFTOOL_TAG("XMP.XMP-photoshop.Author.Credit",         "Xmp.photoshop.Credit")
+        EXIFTOOL_TAG("XMP.XMP-photoshop.Author.Source",         "Xmp.photoshop.Source")
+        EXIFTOOL_TAG("XMP.XMP-tiff.Image.Orientation",          "Xmp.tiff.Orientation")
+        EXIFTOOL_TAG("XMP.XMP-tiff.Camera.Make",                "Xmp.tiff.Make")
+        EXIFTOOL_TAG("XMP.XMP-tiff.Camera.Model",               "Xmp.tiff.Model")
+        EXIFTOOL_TAG("XMP.XMP-exif.Time.DateTimeOriginal",      "Xmp.exif.DateTimeOriginal")
+        EXIFTOOL_TAG("XMP.XMP-exif.Location.GPSLatitude",       "Xmp.exif.GPSLatitude")
+        EXIFTOOL_TAG("XMP.XMP-exif.Location.GPSLongitude",      "Xmp.exif.GPSLongitude")
+        EXIFTOOL_TAG("XMP.XMP-exif.Location.GPSAltitude",       "Xmp.exif.GPSAltitude")
+        EXIFTOOL_TAG("XMP.XMP-exif.Location.GPSAltitudeRef",    "Xmp.exif.GPSAltitudeRef")
+        EXIFTOOL_TAG("XMP.XMP-lr.Image.HierarchicalSubject",    "Xmp.lr.hierarchicalSubject")
+        EXIFTOOL_TAG("XMP.XMP-digiKam.Image.TagsList",          "Xmp.digiKam.TagsList")
+        EXIFTOOL_TAG("XMP.XMP-digiKam.Image.ColorLabel",        "Xmp.digiKam.ColorLabel")
+        EXIFTOOL_TAG("XMP.XMP-digiKam.Image.PickLabel",         "Xmp.digiKam.PickLabel")
+        EXIFTOOL_TAG("XMP.XMP-acdsee.Image.Categories",         "Xmp.acdsee.categories")
+        EXIFTOOL_TAG("XMP.XMP-mwg-rs.Image.RegionInfo",         "Xmp.mwg-rs.Regions")
+        EXIFTOOL_TAG("XMP.XMP-iptcCore.Location.Location",      "Xmp.iptc.Location")
+        EXIFTOOL_TAG("XMP.XMP-iptcCore.Location.CountryCode",   "Xmp.iptc.CountryCode")
+
+        default:
+        {
+            break;
+        }
+    }
+
+#undef EXIFTOOL_TAG
+
+    if (!exifTool || !equals(tagName.constData(), tagName.size(), exifTool))
+    {
+        return QLatin1String();
+    }
+
+    return QLatin1String(exiv2);
+}
+
+} // namespace Digikam
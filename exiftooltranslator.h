@@ -0,0 +1,117 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * https://www.digikam.org
+ *
+ * Date        : 2026-10-15
+ * Description : translation of ExifTool tag names to Exiv2.
+ *
+ * Copyright (C) 2021-2026 by Gilles Caulier <caulier dot gilles at gmail dot com>
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIGIKAM_EXIFTOOL_TRANSLATOR_H
+#define DIGIKAM_EXIFTOOL_TRANSLATOR_H
+
+// Qt Core
+
+#include <QString>
+
+// Local includes
+
+#include "exiftooltagdictionary.h"
+
+namespace Digikam
+{
+
+/**
+ * Translate ExifTool tag names, as "EXIF.IFD0.Camera.Make", to Exiv2 tag names, as "Exif.Image.Make".
+ * The tag names, the ignored groups and the ExifTool type names are matched with switches over
+ * FNV-1a hashes computed at compile time: the compiler rejects any collision in a table, so a
+ * lookup is one hash of the name and one string comparison, without allocation.
+ * Translations of the dictionary entries are also cached by entry identifier. All functions are thread-safe.
+ */
+class ExifToolTranslator
+{
+public:
+
+    /**
+     * Kind of value of an ExifTool format type.
+     */
+    enum TypeCode
+    {
+        UnknownType = 0,
+        StringType,                     ///< "string".
+        IntegerType,                    ///< "int8u", "int16u", "int32u", "int8s", "int16s", "int32s".
+        UndefinedType,                  ///< "undef".
+        RealType                        ///< "double", "float", "rational64s", "rational64u".
+    };
+
+    /**
+     * Translation of a dictionary entry.
+     */
+    class Translation
+    {
+    public:
+
+        Translation()
+          : typeCode    (UnknownType),
+            ignoredGroup(false)
+        {
+        }
+
+        QString  exiv2Name;             ///< Exiv2 tag name, or empty if the tag has no Exiv2 equivalent.
+        TypeCode typeCode;
+        bool     ignoredGroup;          ///< The tag is part of a group without Exiv2 equivalent.
+    };
+
+public:
+
+    static ExifToolTranslator* instance();
+
+    /**
+     * Return the translation of a dictionary entry, computed on first use.
+     */
+    Translation   translate(const ExifToolTagDictionary::Entry* const entry);
+
+    /**
+     * Return the Exiv2 name of an ExifTool tag name, or a null string.
+     */
+    QLatin1String translateToExiv2(const QString& tagName)      const;
+
+    /**
+     * Return true if an ExifTool tag name is part of a group without Exiv2 equivalent.
+     */
+    bool          isIgnoredGroup(const QString& tagName)        const;
+
+    static TypeCode typeCode(const QString& type);
+
+private:
+
+    ExifToolTranslator();
+    ~ExifToolTranslator();
+
+    // Disable
+    ExifToolTranslator(const ExifToolTranslator&)            = delete;
+    ExifToolTranslator& operator=(const ExifToolTranslator&) = delete;
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIGIKAM_EXIFTOOL_TRANSLATOR_H